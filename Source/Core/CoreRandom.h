@@ -0,0 +1,36 @@
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+
+// The same 48-bit linear congruential generator as juce::Random, so seeded
+// sequences match what the engine produced before it left JUCE.
+class CoreRandom
+{
+public:
+    explicit CoreRandom(std::int64_t seedValue = 1) noexcept : seed(seedValue) {}
+
+    void setSeed(std::int64_t newSeed) noexcept { seed = newSeed; }
+
+    int nextInt() noexcept
+    {
+        seed = (std::int64_t)((((std::uint64_t)seed) * 0x5deece66dULL + 11) & 0xffffffffffffULL);
+        return (int)(seed >> 16);
+    }
+
+    // 0 <= result < maxValue
+    int nextInt(int maxValue) noexcept
+    {
+        return (int)((((std::uint32_t)nextInt()) * (std::uint64_t)maxValue) >> 32);
+    }
+
+    // 0 <= result < 1
+    float nextFloat() noexcept
+    {
+        float result = (float)(std::uint32_t)nextInt() / ((float)std::numeric_limits<std::uint32_t>::max() + 1.0f);
+        return std::min(result, 1.0f - std::numeric_limits<float>::epsilon() / 2.0f);
+    }
+
+private:
+    std::int64_t seed;
+};
@@ -0,0 +1,54 @@
+#include "CycleResampler.h"
+#include "RealFft.h"
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+void CycleResampler::resample(const float* frames, int numFrames, double loopStart, double loopLength,
+    float* left, float* right, int size)
+{
+    float* outputs[] = { left, right };
+    if ((size & (size - 1)) != 0) {
+        for (int channel = 0; channel < 2; channel++)
+            for (int i = 0; i < size; i++)
+                outputs[channel][i] = readCubic(frames, numFrames, channel, loopStart + i * loopLength / size);
+        return;
+    }
+
+    int readOrder = 1;
+    while ((1 << readOrder) < loopLength) readOrder++;
+    int sizeOrder = 0;
+    while ((1 << sizeOrder) < size) sizeOrder++;
+    if (sizeOrder == 0) {
+        left[0] = right[0] = 0;
+        return;
+    }
+    int readSize = 1 << readOrder;
+
+    RealFft forward(readOrder);
+    RealFft inverse(sizeOrder);
+    std::vector<float> data((size_t)(2 * std::max(readSize, size)));
+
+    // Bins above either Nyquist are cleared; the rest are rescaled for the inverse's 1/size
+    int keep = std::min(readSize, size) / 2;
+    float scale = (float)size / readSize;
+    for (int channel = 0; channel < 2; channel++) {
+        for (int i = 0; i < readSize; i++)
+            data[(size_t)i] = readCubic(frames, numFrames, channel, loopStart + i * loopLength / readSize);
+        forward.performRealOnlyForwardTransform(data.data());
+        for (int i = 0; i < 2 * keep; i++) data[(size_t)i] *= scale;
+        std::fill(data.begin() + 2 * keep, data.end(), 0.f);
+        inverse.performRealOnlyInverseTransform(data.data());
+        std::copy(data.begin(), data.begin() + size, outputs[channel]);
+    }
+}
+
+// Catmull-Rom, with taps clamped to the frames available
+float CycleResampler::readCubic(const float* frames, int numFrames, int channel, double pos) noexcept
+{
+    int i = (int)std::floor(pos);
+    float t = (float)(pos - i);
+    auto tap = [&](int offset) { return frames[2 * std::clamp(i + offset, 0, numFrames - 1) + channel]; };
+    float y0 = tap(-1), y1 = tap(0), y2 = tap(1), y3 = tap(2);
+    return y1 + 0.5f * t * (y2 - y0 + t * (2 * y0 - 5 * y1 + 4 * y2 - y3 + t * (3 * (y1 - y2) + y3 - y0)));
+}
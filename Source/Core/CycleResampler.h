@@ -0,0 +1,19 @@
+#pragma once
+
+// Resamples one period of a looped stereo signal to a fixed number of samples, so a
+// frozen cycle of any pitch can be saved as a wavetable. For power-of-two sizes the
+// period is read with cubic interpolation at a power-of-two length no shorter than
+// itself and then moved to the target size through the spectrum, dropping harmonics
+// the target can't hold, so the result loops without a seam or aliasing. Other
+// sizes are read with cubic interpolation alone. Allocates; not for the audio thread.
+class CycleResampler
+{
+public:
+    // frames is interleaved stereo and holds the period from loopStart to
+    // loopStart + loopLength, ideally with a frame before and two after for the taps
+    static void resample(const float* frames, int numFrames, double loopStart, double loopLength,
+        float* left, float* right, int size);
+
+private:
+    static float readCubic(const float* frames, int numFrames, int channel, double pos) noexcept;
+};
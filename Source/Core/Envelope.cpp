@@ -0,0 +1,116 @@
+#include "Envelope.h"
+#include <cmath>
+
+void Envelope::setSampleRate(double newSampleRate)
+{
+    sampleRate = (float)newSampleRate;
+    updateSegments();
+}
+
+void Envelope::setParameters(float attackSeconds, float decaySeconds, float newSustain, float releaseSeconds)
+{
+    segments[0].seconds = attackSeconds;
+    segments[1].seconds = decaySeconds;
+    segments[2].seconds = releaseSeconds;
+    sustainLevel = std::clamp(newSustain, 0.f, 1.f);
+    updateSegments();
+    if (state != idle) updateSegment();
+}
+
+void Envelope::setCurve(float newCurve)
+{
+    curve = std::clamp(newCurve, 0.f, 1.f);
+    // Distance the exponential overshoots its end point by, relative to the segment
+    ratio = std::pow(10.f, -4 * curve);
+    updateSegments();
+    if (state != idle) updateSegment();
+}
+
+void Envelope::updateSegments()
+{
+    for (auto& segment : segments) {
+        segment.length = (int)std::lround(segment.seconds * sampleRate);
+        // Reaching the end point from the start takes `length` samples of decay
+        // towards a target that lies `ratio` segment-heights beyond it
+        segment.coefficient = segment.length > 0 ? std::pow(ratio / (1 + ratio), 1.f / segment.length) : 0.f;
+        float power = 1;
+        for (auto& p : segment.powers) {
+            power *= segment.coefficient;
+            p = power;
+        }
+    }
+}
+
+void Envelope::enterState(State newState) noexcept
+{
+    state = newState;
+    if (state == release) releaseStart = level;
+    updateSegment();
+}
+
+// Works out the rest of the current segment from the present level, so a change of
+// parameters mid-segment carries on at the new rate towards the new end point, and
+// a held note follows the sustain level. Moves on past any segment already finished.
+void Envelope::updateSegment() noexcept
+{
+    for (;;) {
+        if (state == idle) {
+            level = 0;
+            return;
+        }
+        if (state == sustain) {
+            level = sustainLevel;
+            return;
+        }
+
+        auto& segment = segmentFor(state);
+        float start = state == attack ? 0.f : (state == decay ? 1.f : releaseStart);
+        endLevel = state == attack ? 1.f : (state == decay ? sustainLevel : 0.f);
+        target = endLevel + ratio * (endLevel - start);
+
+        // A new end point can land behind the present level; the segment is then over
+        float distance = endLevel - level;
+        linear = curve == 0;
+        samplesLeft = 0;
+        if (segment.length > 0 && distance * (endLevel - start) > 0) {
+            if (linear) {
+                slope = (endLevel - start) / segment.length;
+                samplesLeft = (int)std::ceil(distance / slope);
+            }
+            else {
+                float fraction = (endLevel - target) / (level - target);
+                samplesLeft = (int)std::ceil(std::log(fraction) / std::log(segment.coefficient));
+            }
+        }
+        if (samplesLeft > 0) return;
+
+        level = endLevel;
+        state = state == attack ? decay : (state == decay ? sustain : idle);
+    }
+}
+
+void Envelope::render(float* out, int numSamples) noexcept
+{
+    render(numSamples, [out](int offset, const Piece& piece) {
+        for (int j = 0; j < piece.length; j++)
+            out[offset + j] = piece.at(j);
+    });
+}
+
+void Envelope::skip(int numSamples) noexcept
+{
+    while (numSamples > 0 && state != idle && state != sustain) {
+        int n = std::min(numSamples, samplesLeft);
+        numSamples -= n;
+        samplesLeft -= n;
+
+        if (samplesLeft > 0) {
+            if (linear) level += slope * n;
+            else level = target + (level - target) * std::pow(segmentFor(state).coefficient, (float)n);
+        }
+        else {
+            level = endLevel;
+            enterState(state == attack ? decay : (state == decay ? sustain : idle));
+        }
+    }
+}
@@ -0,0 +1,113 @@
+#pragma once
+#include <algorithm>
+
+// ADSR with linear or exponential segments. Rather than stepping a state machine
+// per sample, render() hands out each segment's share of a chunk in closed form: a
+// ramp for linear segments, a precomputed geometric series for exponential ones.
+class Envelope
+{
+public:
+    static constexpr int maxChunk = 32;
+
+    // A stretch of output that follows one formula; sample j of it is at(j)
+    struct Piece
+    {
+        enum Shape { flat, ramp, curve };
+
+        Shape shape;
+        int length;
+        float level;
+        float slope = 0;
+        float target = 0;
+        float distance = 0;
+        const float* powers = nullptr;
+
+        float at(int j) const noexcept
+        {
+            if (shape == ramp) return level + slope * (j + 1);
+            if (shape == curve) return target + distance * powers[j];
+            return level;
+        }
+    };
+
+    void setSampleRate(double newSampleRate);
+    void setParameters(float attackSeconds, float decaySeconds, float sustainLevel, float releaseSeconds);
+    void setCurve(float newCurve);
+
+    void noteOn() noexcept { enterState(attack); }
+    void noteOff() noexcept { if (state != idle) enterState(release); }
+    void reset() noexcept { state = idle; level = 0; }
+    bool isActive() const noexcept { return state != idle; }
+
+    void render(float* out, int numSamples) noexcept;
+
+    // Calls body(offset, piece) for consecutive pieces covering numSamples, so the
+    // caller can apply the envelope inside its own loop without a buffer
+    template <typename Body>
+    void render(int numSamples, Body&& body) noexcept;
+    void skip(int numSamples) noexcept;
+
+private:
+    enum State { idle, attack, decay, sustain, release };
+
+    struct Segment
+    {
+        float seconds = 0;
+        int length = 0;
+        float coefficient = 0;
+        float powers[maxChunk] = {};
+    };
+
+    void updateSegments();
+    void enterState(State newState) noexcept;
+    void updateSegment() noexcept;
+    Segment& segmentFor(State s) noexcept { return segments[s == attack ? 0 : (s == decay ? 1 : 2)]; }
+
+    Segment segments[3];
+    float sustainLevel = 1;
+    float sampleRate = 96000;
+
+    // 0 is linear; towards 1 the segments bend further into exponential curves
+    float curve = 0;
+    float ratio = 1;
+
+    State state = idle;
+    float level = 0;
+    float releaseStart = 0;
+    float endLevel = 0;
+    float target = 0;
+    float slope = 0;
+    bool linear = true;
+    int samplesLeft = 0;
+};
+
+template <typename Body>
+void Envelope::render(int numSamples, Body&& body) noexcept
+{
+    int i = 0;
+    while (i < numSamples) {
+        if (state == idle || state == sustain) {
+            body(i, Piece{ Piece::flat, numSamples - i, level });
+            return;
+        }
+
+        int n = std::min({ numSamples - i, samplesLeft, maxChunk });
+        Piece piece = linear ? Piece{ Piece::ramp, n, level, slope }
+                             : Piece{ Piece::curve, n, level, 0, target, level - target, segmentFor(state).powers };
+        samplesLeft -= n;
+
+        if (samplesLeft > 0) {
+            body(i, piece);
+            level = piece.at(n - 1);
+        }
+        else {
+            // The segment's last sample lands exactly on its end point
+            piece.length = n - 1;
+            if (piece.length > 0) body(i, piece);
+            body(i + n - 1, Piece{ Piece::flat, 1, endLevel });
+            level = endLevel;
+            enterState(state == attack ? decay : (state == decay ? sustain : idle));
+        }
+        i += n;
+    }
+}
@@ -0,0 +1,200 @@
+#pragma once
+#include <algorithm>
+#include <cmath>
+#include <vector>
+#include "SampleFormat.h"
+
+// Capture ring that also keeps running level statistics per block of statsBlock
+// samples, accumulated as samples are written, so the level of recent material can
+// be read without rescanning the ring.
+template<typename T>
+class FixedDelayBuffer
+{
+public:
+    static constexpr int defaultSize = 96000;
+    static constexpr int statsBlock = 256;
+
+    struct Stats
+    {
+        double sum = 0;
+        double squares = 0;
+        float peak = 0;
+        int count = 0;
+
+        void add(const Stats& other) noexcept
+        {
+            sum += other.sum;
+            squares += other.squares;
+            peak = std::max(peak, other.peak);
+            count += other.count;
+        }
+    };
+
+    explicit FixedDelayBuffer(int size = defaultSize)
+    {
+        setSize(size);
+    }
+
+    // Reallocates and zeroes the ring; not for the audio thread
+    void setSize(int size)
+    {
+        arr.assign((size_t)size, T());
+        blocks.assign((size_t)((size + statsBlock - 1) / statsBlock), Stats());
+        for (size_t b = 0; b < blocks.size(); b++)
+            blocks[b].count = std::min(statsBlock, size - (int)b * statsBlock);
+
+        read = 0;
+        write = std::max(0, size - 1);
+        silentSamples = size;
+    }
+
+    // Statistics of exactly numSamples samples ending delay samples before the newest.
+    // Whole blocks come from their records and only the partial blocks at either end
+    // are scanned, so it costs one step per block plus at most two blocks of samples.
+    Stats getRecentStats(int numSamples, int delay = 0) const noexcept
+    {
+        Stats stats;
+        int size = getSize();
+        numSamples = std::min(numSamples, size);
+        if (numSamples <= 0) return stats;
+        int end = ((write - delay) % size + size) % size + 1;
+        int start = end - numSamples;
+        if (start < 0) {
+            addRange(stats, start + size, size);
+            start = 0;
+        }
+        addRange(stats, start, end);
+        return stats;
+    }
+    T readOldestSample() const noexcept { return arr[(size_t)read]; }
+    T readNewestSample() const noexcept { return arr[(size_t)write]; }
+    int getSize() const noexcept { return (int)arr.size(); }
+
+    // Copies the whole ring, oldest sample first, into every stride-th element of dest
+    void copyOrdered(T* dest, int stride = 1) const noexcept {
+        const T* src = arr.data();
+        int first = getSize() - read;
+        for (int i = 0; i < first; i++) dest[i * stride] = src[read + i];
+        dest += first * stride;
+        for (int i = 0; i < read; i++) dest[i * stride] = src[i];
+    }
+
+    // Source samples are converted to the storage type on the way in
+    template <typename Src>
+    void writeBlock(const Src* src, int numSamples) noexcept
+    {
+        int size = getSize();
+        if (size == 0) return;
+        if (numSamples > size) {
+            src += numSamples - size;
+            numSamples = size;
+        }
+        int start = advance(numSamples);
+        int first = std::min(numSamples, size - start);
+        T* dest = arr.data();
+        SampleFormat::write(dest + start, src, first);
+        SampleFormat::write(dest, src + first, numSamples - first);
+        accumulate(start, first);
+        accumulate(0, numSamples - first);
+        silentSamples = 0;
+    }
+
+    // Once the whole ring is zero, further silence leaves it unchanged
+    void writeSilence(int numSamples) noexcept
+    {
+        int size = getSize();
+        if (silentSamples >= size) return;
+        numSamples = std::min(numSamples, size);
+        int start = advance(numSamples);
+        int first = std::min(numSamples, size - start);
+        T* dest = arr.data();
+        std::fill(dest + start, dest + start + first, T());
+        std::fill(dest, dest + numSamples - first, T());
+        accumulate(start, first);
+        accumulate(0, numSamples - first);
+        silentSamples += numSamples;
+    }
+
+    T writeSample(T sample)
+    {
+        ++write;
+        if (write >= getSize())
+            write = 0;
+        ++read;
+        if (read >= getSize())
+            read = 0;
+        auto discarded = arr[(size_t)write];
+        arr[(size_t)write] = sample;
+        accumulate(write, 1);
+        silentSamples = sample == T() ? silentSamples + 1 : 0;
+        return discarded;
+    }
+private:
+    // Adds ring samples [start, end), which must not wrap
+    void addRange(Stats& stats, int start, int end) const noexcept
+    {
+        while (start < end) {
+            int blockStart = start / statsBlock * statsBlock;
+            int blockEnd = std::min(blockStart + statsBlock, getSize());
+            if (start == blockStart && blockEnd <= end) {
+                stats.add(blocks[(size_t)(start / statsBlock)]);
+                start = blockEnd;
+                continue;
+            }
+            Stats partial;
+            partial.count = std::min(end, blockEnd) - start;
+            for (int i = start; i < start + partial.count; i++) {
+                double s = SampleFormat::toFloat(arr[(size_t)i]);
+                partial.sum += s;
+                partial.squares += s * s;
+                partial.peak = std::max(partial.peak, (float)std::abs(s));
+            }
+            stats.add(partial);
+            start += partial.count;
+        }
+    }
+
+    // Folds freshly written ring samples [start, start + numSamples) into their blocks.
+    // A block restarts when writing reaches its first sample, so each block only ever
+    // describes samples from the current lap.
+    void accumulate(int start, int numSamples) noexcept
+    {
+        for (int end = start + numSamples; start < end;) {
+            auto& block = blocks[(size_t)(start / statsBlock)];
+            if (start % statsBlock == 0) block = Stats();
+            int n = std::min(end, (start / statsBlock + 1) * statsBlock) - start;
+            double sum = 0, squares = 0;
+            float peak = block.peak;
+            for (int i = start; i < start + n; i++) {
+                double s = SampleFormat::toFloat(arr[(size_t)i]);
+                sum += s;
+                squares += s * s;
+                peak = std::max(peak, (float)std::abs(s));
+            }
+            block.sum += sum;
+            block.squares += squares;
+            block.peak = peak;
+            block.count += n;
+            start += n;
+        }
+    }
+
+    // Moves the write head past numSamples and returns the index of the first of them
+    int advance(int numSamples) noexcept
+    {
+        int size = getSize();
+        int start = write + 1;
+        if (start >= size) start = 0;
+        write = (start + numSamples - 1) % size;
+        read = write + 1;
+        if (read >= size) read = 0;
+        return start;
+    }
+
+
+    std::vector<T> arr;
+    std::vector<Stats> blocks;
+    int read = 0;
+    int write;
+    int silentSamples = 0;
+};
\ No newline at end of file
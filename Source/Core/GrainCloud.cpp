@@ -0,0 +1,108 @@
+#include "GrainCloud.h"
+#include "PitchMath.h"
+#include <cmath>
+
+void GrainCloud::prepare(double sRate)
+{
+    sampleRate = sRate;
+    fadeSamples = std::max(1, (int)(0.02 * sRate));
+    setGrainLength(grainLength);
+    finishFade();
+}
+
+void GrainCloud::setNumGrains(int n)
+{
+    n = std::clamp(n, 1, maxGrains);
+    if (n == targetGrains) return;
+
+    // New grains start silent and staggered; surplus ones fade out where they are.
+    // Each level steps straight to its target, so a fade that interrupts another
+    // lands exactly on 0 or 1 without clamping.
+    for (int k = numGrains; k < n; k++) {
+        position[k] = position[0];
+        anchor[k] = anchor[0];
+        ratio[k] = 1;
+        inverseRatio[k] = 1;
+        phase[k] = (float)k / n;
+        level[k] = 0;
+    }
+    for (int k = 0; k < std::max(n, numGrains); k++)
+        levelStep[k] = ((k < n ? 1.f : 0.f) - level[k]) / fadeSamples;
+
+    targetGrains = n;
+    numGrains = std::max(n, numGrains);
+    fadeCountdown = fadeSamples;
+    gainStep = (normalisingGain(targetGrains) - gain) / fadeSamples;
+    updateCycleLimit();
+}
+
+// Drops the faded-out grains and settles the gain
+void GrainCloud::finishFade() noexcept
+{
+    numGrains = targetGrains;
+    fadeCountdown = 0;
+    gainStep = 0;
+    for (int k = 0; k < maxGrains; k++) {
+        level[k] = 1;
+        levelStep[k] = 0;
+    }
+    gain = normalisingGain(numGrains);
+}
+
+void GrainCloud::setGrainLength(float seconds)
+{
+    grainLength = seconds;
+    phaseIncrement = 1 / std::max(1.f, grainLength * sampleRate);
+}
+
+void GrainCloud::setJitter(float amount)
+{
+    jitter = std::clamp(amount, 0.f, 1.f);
+}
+
+void GrainCloud::setFormantSpread(float semitones)
+{
+    spread = semitones;
+}
+
+void GrainCloud::reset(int tableSize, float start, float end, float cycleLength)
+{
+    lastIndex = std::max(0, tableSize - 2);
+    regionStart = start;
+    regionEnd = std::min(end, (float)(tableSize - 1));
+    finishFade();
+    for (int k = 0; k < numGrains; k++) {
+        spawn(k, cycleLength);
+        phase[k] = (float)k / numGrains;
+    }
+    updateCycleLimit();
+}
+
+void GrainCloud::spawn(int k, float cycleLength)
+{
+    phase[k] -= std::floor(phase[k]);
+    ratio[k] = spread > 0 ? PitchMath::semitonesToRatio(spread * (random.nextFloat() * 2 - 1)) : 1.f;
+    inverseRatio[k] = 1 / ratio[k];
+
+    // Each grain loops one cycle ending somewhere in the jittered tail of the frozen region
+    float loop = std::min(cycleLength * ratio[k], regionEnd - regionStart);
+    float earliest = regionStart + loop;
+    anchor[k] = std::max(earliest, regionEnd - random.nextFloat() * jitter * std::max(0.f, regionEnd - earliest));
+    position[k] = anchor[k] - loop;
+    updateCycleLimit();
+}
+
+// The longest cycle every grain can wrap by without reaching back past the region's start
+void GrainCloud::updateCycleLimit() noexcept
+{
+    cycleLimit = regionEnd;
+    for (int k = 0; k < numGrains; k++)
+        cycleLimit = std::min(cycleLimit, (anchor[k] - regionStart) / ratio[k]);
+}
+
+// Staggered parabolic windows have a mean square of 8/15, so n grains over
+// uncorrelated material sum to sqrt(8n/15) times its RMS
+float GrainCloud::normalisingGain(int n) noexcept
+{
+    return std::sqrt(15.f / (8.f * (float)n));
+}
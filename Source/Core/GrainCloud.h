@@ -0,0 +1,132 @@
+#pragma once
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include "CoreRandom.h"
+#include "SampleFormat.h"
+
+// Up to maxGrains windowed read heads over a frozen table of interleaved stereo frames.
+// Grain state is kept as parallel arrays so the per-sample arithmetic over grains is
+// one branch-free pass that can be vectorised. Changing the grain count while sounding
+// fades grains in or out and ramps the normalising gain, so it never clicks.
+class GrainCloud
+{
+public:
+    static constexpr int maxGrains = 32;
+
+    // Shortest cycle a grain wraps by, so the overshoot divided by it stays finite
+    static constexpr float minCycle = 1.0f / 64;
+
+    GrainCloud() { finishFade(); }
+
+    void prepare(double sampleRate);
+    void setNumGrains(int n);
+    void setGrainLength(float seconds);
+    void setJitter(float amount);
+    void setFormantSpread(float semitones);
+    void setSeed(std::int64_t seed) { random.setSeed(seed); }
+    void reset(int tableSize, float start, float end, float cycleLength);
+
+    template <typename T, typename S>
+    void renderSample(const S* frames, float formant, float cycleLength, T& outL, T& outR) noexcept
+    {
+        // spawn keeps every anchor inside the region and at least one cycle from its
+        // start, and the cycle is held under cycleLimit, so a grain stays in the region.
+        // The clamp on the read position is only a backstop against a broken invariant.
+        // Locals, because the stores below could otherwise alias the members
+        const int n = numGrains;
+        const float cycle = std::max(std::min(cycleLength, cycleLimit), minCycle);
+        const float inverseCycle = 1 / cycle;
+        const float increment = phaseIncrement;
+        const float last = (float)lastIndex;
+        for (int k = 0; k < n; k++) {
+            float p = std::min(std::max(position[k], 0.f), last);
+            int i = (int)p;
+            index[k] = 2 * i;
+            fraction[k] = p - (float)i;
+            weight[k] = 4 * phase[k] * (1 - phase[k]) * level[k];
+            level[k] += levelStep[k];
+
+            // Past its anchor a grain goes back by as many whole cycles as it overshot;
+            // a short region and a fast read can make that more than one per sample.
+            // The overshoot is never negative where it is used, so truncating floors it.
+            float next = position[k] + formant * ratio[k];
+            float span = cycle * ratio[k];
+            float over = next - anchor[k];
+            float laps = (float)(std::int32_t)(over * inverseCycle * inverseRatio[k]) + 1;
+            position[k] = next - maskedBy(over >= 0, laps * span);
+            phase[k] += increment;
+        }
+
+        // The table reads are a gather, so they get a pass of their own
+        T sumL = 0;
+        T sumR = 0;
+        for (int k = 0; k < numGrains; k++) {
+            assert(index[k] >= 0 && index[k] <= 2 * lastIndex);
+            const S* frame = frames + index[k];
+            T t = (T)fraction[k];
+            T l0 = (T)SampleFormat::toFloat(frame[0]);
+            T r0 = (T)SampleFormat::toFloat(frame[1]);
+            T l1 = (T)SampleFormat::toFloat(frame[2]);
+            T r1 = (T)SampleFormat::toFloat(frame[3]);
+            sumL += (l0 + t * (l1 - l0)) * weight[k];
+            sumR += (r0 + t * (r1 - r0)) * weight[k];
+        }
+        for (int k = 0; k < numGrains; k++) {
+            if (phase[k] >= 1) spawn(k, cycleLength);
+        }
+        outL = sumL * gain;
+        outR = sumR * gain;
+        if (fadeCountdown > 0 && --fadeCountdown == 0) finishFade();
+        else gain += gainStep;
+    }
+
+private:
+    // value when condition holds, otherwise 0. A ?: here becomes a branch under strict
+    // IEEE settings (the multiply could trap), which stops the loop vectorising.
+    static float maskedBy(bool condition, float value) noexcept
+    {
+        std::uint32_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        bits &= 0u - (std::uint32_t)condition;
+        std::memcpy(&value, &bits, sizeof(value));
+        return value;
+    }
+
+    void spawn(int k, float cycleLength);
+    void updateCycleLimit() noexcept;
+    static float normalisingGain(int n) noexcept;
+    void finishFade() noexcept;
+
+    alignas(16) float position[maxGrains] = {};
+    alignas(16) float anchor[maxGrains] = {};
+    alignas(16) float phase[maxGrains] = {};
+    alignas(16) float ratio[maxGrains] = {};
+    alignas(16) float inverseRatio[maxGrains] = {};
+    alignas(16) float level[maxGrains] = {};
+    alignas(16) float levelStep[maxGrains] = {};
+    alignas(16) std::int32_t index[maxGrains] = {};
+    alignas(16) float fraction[maxGrains] = {};
+    alignas(16) float weight[maxGrains] = {};
+
+    // numGrains are rendered; during a fade down the extra ones are fading out
+    int numGrains = 8;
+    int targetGrains = 8;
+    int fadeSamples = 1;
+    int fadeCountdown = 0;
+    float gainStep = 0;
+    int lastIndex = 0;
+    float regionStart = 0;
+    float regionEnd = 0;
+    float cycleLimit = 0;
+    float phaseIncrement = 0.0001f;
+    float gain = 1;
+
+    float sampleRate = 96000;
+    float grainLength = 0.1f;
+    float jitter = 0.25f;
+    float spread = 0;
+
+    CoreRandom random;
+};
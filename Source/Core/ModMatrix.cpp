@@ -0,0 +1,65 @@
+#include "ModMatrix.h"
+#include <cmath>
+
+void ModMatrix::prepare(double sRate)
+{
+    sampleRate = sRate;
+    resetPhases();
+}
+
+void ModMatrix::resetPhases()
+{
+    for (auto& lfo : lfos) lfo.phase = 0;
+    advance(0);
+}
+
+void ModMatrix::setSlot(int slot, int source, int destination, float amount)
+{
+    slots[slot].source = std::clamp(source, 0, numSources - 1);
+    slots[slot].destination = std::clamp(destination, 0, numDestinations - 1);
+    slots[slot].amount = amount;
+}
+
+void ModMatrix::setLfo(int index, float rateHz, int shape)
+{
+    lfos[index].rate = rateHz;
+    lfos[index].shape = shape;
+}
+
+bool ModMatrix::isRouted(Destination destination) const noexcept
+{
+    for (auto& slot : slots) {
+        if (slot.source != none && slot.destination == destination && slot.amount != 0) return true;
+    }
+    return false;
+}
+
+float ModMatrix::lfoValue(const Lfo& lfo)
+{
+    switch (lfo.shape) {
+    case triangle:
+        return 1 - 4 * std::abs(lfo.phase - 0.5f);
+    case saw:
+        return 2 * lfo.phase - 1;
+    case square:
+        return lfo.phase < 0.5f ? 1.f : -1.f;
+    default:
+        return std::sin(6.2831853f * lfo.phase);
+    }
+}
+
+void ModMatrix::advance(int numSamples)
+{
+    for (int i = 0; i < numLfos; i++) {
+        lfos[i].phase += lfos[i].rate * numSamples / sampleRate;
+        lfos[i].phase -= std::floor(lfos[i].phase);
+    }
+    sources[none] = 0;
+    sources[lfo1] = lfoValue(lfos[0]);
+    sources[lfo2] = lfoValue(lfos[1]);
+
+    for (auto& output : outputs) output = 0;
+    for (auto& slot : slots) {
+        if (slot.source != none) outputs[slot.destination] += sources[slot.source] * slot.amount;
+    }
+}
@@ -0,0 +1,53 @@
+#pragma once
+#include <algorithm>
+
+// Control-rate modulation sources routed to a handful of voice destinations.
+// advance() is called once every controlInterval samples; the voice ramps
+// linearly between successive outputs.
+class ModMatrix
+{
+public:
+    enum Source { none, lfo1, lfo2, controller, velocity, aftertouch, numSources };
+    enum Destination { formant, formantTarget, wet, dry, portamento, numDestinations };
+    enum Shape { sine, triangle, saw, square, numShapes };
+
+    static constexpr int numSlots = 4;
+    static constexpr int numLfos = 2;
+    static constexpr int controlInterval = 32;
+
+    static constexpr const char* sourceNames[numSources] = { "None", "LFO 1", "LFO 2", "MIDI CC", "Velocity", "Aftertouch" };
+    static constexpr const char* destinationNames[numDestinations] = { "Formant", "Formant Target", "Wet", "Dry", "Portamento" };
+    static constexpr const char* shapeNames[numShapes] = { "Sine", "Triangle", "Saw", "Square" };
+
+    void prepare(double sampleRate);
+    void resetPhases();
+    void setSlot(int slot, int source, int destination, float amount);
+    void setLfo(int index, float rateHz, int shape);
+    void setSourceValue(Source source, float value) { sources[source] = value; }
+    void advance(int numSamples);
+    float getOutput(Destination destination) const noexcept { return outputs[destination]; }
+    bool isRouted(Destination destination) const noexcept;
+
+private:
+    struct Slot
+    {
+        int source = none;
+        int destination = formant;
+        float amount = 0;
+    };
+
+    struct Lfo
+    {
+        float phase = 0;
+        float rate = 1;
+        int shape = sine;
+    };
+
+    static float lfoValue(const Lfo& lfo);
+
+    Slot slots[numSlots];
+    Lfo lfos[numLfos];
+    float sources[numSources] = {};
+    float outputs[numDestinations] = {};
+    float sampleRate = 96000;
+};
@@ -0,0 +1,24 @@
+#include "OnsetDetector.h"
+
+void OnsetDetector::prepare(double sampleRate)
+{
+    // Peak follower falls by about 60 dB in 50 ms; the average settles over 150 ms
+    fastDecay = (float)std::pow(0.001, chunkSize / (0.05 * sampleRate));
+    slowCoefficient = 1 - (float)std::exp(-chunkSize / (0.15 * sampleRate));
+    minimumHoldoff = (int)(0.05 * sampleRate);
+    holdoff = std::max(holdoff, minimumHoldoff);
+    reset();
+}
+
+void OnsetDetector::reset()
+{
+    fast = 0;
+    slow = 0;
+    countdown = 0;
+}
+
+// 0 needs a jump of 4x over the recent level, 1 only 1.25x
+void OnsetDetector::setSensitivity(float amount)
+{
+    ratio = 4.f - 2.75f * std::clamp(amount, 0.f, 1.f);
+}
@@ -0,0 +1,53 @@
+#pragma once
+#include <algorithm>
+#include <cmath>
+
+// Streaming onset detector for auto-freeze. A peak follower and a slower average
+// run once per chunk of chunkSize samples; only the chunk that fires is scanned
+// per sample to find the exact onset, so the cost stays a single abs/max pass.
+class OnsetDetector
+{
+public:
+    static constexpr int chunkSize = 16;
+
+    void prepare(double sampleRate);
+    void reset();
+    void setSensitivity(float amount);
+    void setHoldoff(int numSamples) { holdoff = std::max(numSamples, minimumHoldoff); }
+
+    // Returns the index of the first onset in the block, or -1
+    template <typename T>
+    int process(const T* left, const T* right, int numSamples)
+    {
+        int onset = -1;
+        for (int start = 0; start < numSamples; start += chunkSize) {
+            int n = std::min(chunkSize, numSamples - start);
+            float peak = 0;
+            for (int i = start; i < start + n; i++)
+                peak = std::max({ peak, (float)std::abs(left[i]), (float)std::abs(right[i]) });
+
+            float threshold = std::max(slow * ratio, noiseFloor);
+            if (onset < 0 && countdown <= 0 && peak > threshold) {
+                onset = start;
+                while (std::max((float)std::abs(left[onset]), (float)std::abs(right[onset])) <= threshold) onset++;
+                countdown = holdoff + onset - start;
+            }
+
+            fast = std::max(peak, fast * fastDecay);
+            slow += (fast - slow) * slowCoefficient;
+            countdown -= n;
+        }
+        return onset;
+    }
+
+private:
+    float fast = 0;
+    float slow = 0;
+    float fastDecay = 0.9f;
+    float slowCoefficient = 0.01f;
+    float ratio = 2;
+    float noiseFloor = 0.001f;
+    int holdoff = 4800;
+    int minimumHoldoff = 4800;
+    int countdown = 0;
+};
@@ -0,0 +1,12 @@
+#include "PitchMath.h"
+#include <cmath>
+
+const PitchMath::Tables PitchMath::tables;
+
+PitchMath::Tables::Tables()
+{
+    for (int i = 0; i < numRatios; i++)
+        ratios[i] = (float)std::exp2((i - semitoneRange * stepsPerSemitone) / (12.0 * stepsPerSemitone));
+    for (int i = 0; i < 128; i++)
+        noteHz[i] = (float)(440.0 * std::exp2((i - 69) / 12.0));
+}
@@ -0,0 +1,59 @@
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+
+// Pitch and formant conversions backed by read-only tables that are built once
+// when the plugin is loaded and shared by every instance in the process.
+class PitchMath
+{
+public:
+    static constexpr int semitoneRange = 48;
+    static constexpr int stepsPerSemitone = 32;
+
+    // 2^(semitones / 12). Within +/- semitoneRange this is a table lookup with linear
+    // interpolation (relative error below 6e-7, about 0.001 cents); beyond it, fastExp2.
+    // The index is worked out in double so that rounding it adds nothing to the error.
+    static float semitonesToRatio(float semitones) noexcept
+    {
+        double index = ((double)semitones + semitoneRange) * stepsPerSemitone;
+        if (index < 0 || index >= numRatios - 1) return fastExp2(semitones * (1.f / 12));
+        int i = (int)index;
+        double t = index - i;
+        return (float)(tables.ratios[i] + t * ((double)tables.ratios[i + 1] - tables.ratios[i]));
+    }
+
+    static float noteToHz(int midiNote) noexcept { return tables.noteHz[std::clamp(midiNote, 0, 127)]; }
+
+    // 14-bit pitch wheel value to a ratio of 0.5 to 2 (+/- 12 semitones)
+    static float pitchWheelToRatio(int value) noexcept { return semitonesToRatio((value - 8192) * (12.f / 8192)); }
+
+    // 2^x for audio-rate use: degree-5 minimax polynomial on the fraction with the
+    // integer part written straight into the exponent. Relative error is below
+    // 1.8e-7 (about 0.0003 cents) over the clamped input range of +/-126.
+    static float fastExp2(float x) noexcept
+    {
+        x = x < -126.f ? -126.f : (x > 126.f ? 126.f : x);
+        std::int32_t i = (std::int32_t)x;
+        i -= (x < (float)i);
+        float f = x - (float)i;
+        float p = 0.999999925066056f + f * (0.693153073200169f + f * (0.240153617044375f
+            + f * (0.0558263180532956f + f * (0.00898934009049466f + f * 0.00187757667519148f))));
+        std::int32_t bits = (i + 127) << 23;
+        float scale;
+        std::memcpy(&scale, &bits, sizeof(scale));
+        return p * scale;
+    }
+
+private:
+    static constexpr int numRatios = 2 * semitoneRange * stepsPerSemitone + 1;
+
+    struct Tables
+    {
+        Tables();
+        float ratios[numRatios];
+        float noteHz[128];
+    };
+
+    static const Tables tables;
+};
@@ -0,0 +1,95 @@
+#include "RealFft.h"
+#include <cmath>
+#include <utility>
+
+RealFft::RealFft(int order) : size(1 << order), half(size / 2)
+{
+    const double twoPi = 6.283185307179586;
+    twiddles.resize((size_t)std::max(1, half / 2));
+    for (int k = 0; k < half / 2; k++)
+        twiddles[(size_t)k] = std::polar(1.f, (float)(-twoPi * k / half));
+    realTwiddles.resize((size_t)half + 1);
+    for (int k = 0; k <= half; k++)
+        realTwiddles[(size_t)k] = std::polar(1.f, (float)(-twoPi * k / size));
+
+    int bits = order - 1;
+    bitReverse.resize((size_t)half);
+    for (int i = 0; i < half; i++) {
+        int r = 0;
+        for (int b = 0; b < bits; b++)
+            r |= ((i >> b) & 1) << (bits - 1 - b);
+        bitReverse[(size_t)i] = r;
+    }
+}
+
+void RealFft::transform(Complex* data, bool inverse) const noexcept
+{
+    for (int i = 0; i < half; i++) {
+        int j = bitReverse[(size_t)i];
+        if (i < j) std::swap(data[i], data[j]);
+    }
+
+    for (int length = 2; length <= half; length <<= 1) {
+        int step = half / length;
+        for (int start = 0; start < half; start += length) {
+            for (int k = 0; k < length / 2; k++) {
+                Complex w = twiddles[(size_t)(k * step)];
+                if (inverse) w = std::conj(w);
+                Complex a = data[start + k];
+                Complex b = data[start + k + length / 2] * w;
+                data[start + k] = a + b;
+                data[start + k + length / 2] = a - b;
+            }
+        }
+    }
+}
+
+void RealFft::performRealOnlyForwardTransform(float* data) const noexcept
+{
+    auto* z = reinterpret_cast<Complex*>(data);
+    transform(z, false);
+
+    // Split the packed even/odd spectra: X[k] = E[k] + W^k O[k]
+    Complex z0 = z[0];
+    z[0] = { z0.real() + z0.imag(), 0 };
+    z[half] = { z0.real() - z0.imag(), 0 };
+    for (int k = 1; k <= half / 2; k++) {
+        Complex a = z[k];
+        Complex b = std::conj(z[half - k]);
+        Complex even = (a + b) * 0.5f;
+        Complex odd = (a - b) * Complex(0, -0.5f);
+        Complex c = std::conj(a);
+        Complex d = z[half - k];
+        Complex evenMirror = (d + c) * 0.5f;
+        Complex oddMirror = (d - c) * Complex(0, -0.5f);
+        z[k] = even + realTwiddles[(size_t)k] * odd;
+        z[half - k] = evenMirror + realTwiddles[(size_t)(half - k)] * oddMirror;
+    }
+}
+
+void RealFft::performRealOnlyInverseTransform(float* data) const noexcept
+{
+    auto* z = reinterpret_cast<Complex*>(data);
+
+    // Rebuild the packed spectrum: Z[k] = E[k] + i O[k]
+    Complex x0 = z[0];
+    Complex xHalf = z[half];
+    z[0] = Complex(x0.real() + xHalf.real(), x0.real() - xHalf.real()) * 0.5f;
+    for (int k = 1; k <= half / 2; k++) {
+        Complex a = z[k];
+        Complex b = std::conj(z[half - k]);
+        Complex even = (a + b) * 0.5f;
+        Complex odd = (a - b) * 0.5f * std::conj(realTwiddles[(size_t)k]);
+        Complex c = std::conj(a);
+        Complex d = z[half - k];
+        Complex evenMirror = (d + c) * 0.5f;
+        Complex oddMirror = (d - c) * 0.5f * std::conj(realTwiddles[(size_t)(half - k)]);
+        z[k] = even + Complex(0, 1) * odd;
+        z[half - k] = evenMirror + Complex(0, 1) * oddMirror;
+    }
+
+    transform(z, true);
+    float scale = 1.f / half;
+    for (int i = 0; i < size; i++)
+        data[i] *= scale;
+}
@@ -0,0 +1,30 @@
+#pragma once
+#include <algorithm>
+#include <complex>
+#include <vector>
+
+// Radix-2 FFT for real signals, laid out like juce::dsp::FFT's real-only
+// transforms: data holds 2 * getSize() floats; the forward transform leaves bins
+// 0..size/2 as interleaved re/im pairs, and the inverse reads them back and
+// returns size real samples scaled by 1/size. Internally it runs a half-size
+// complex FFT on the even/odd samples packed as re/im.
+class RealFft
+{
+public:
+    explicit RealFft(int order);
+
+    int getSize() const noexcept { return size; }
+    void performRealOnlyForwardTransform(float* data) const noexcept;
+    void performRealOnlyInverseTransform(float* data) const noexcept;
+
+private:
+    using Complex = std::complex<float>;
+
+    void transform(Complex* data, bool inverse) const noexcept;
+
+    int size;
+    int half;
+    std::vector<Complex> twiddles;      // e^(-2 pi i k / half), k < half / 2
+    std::vector<Complex> realTwiddles;  // e^(-2 pi i k / size), k <= half
+    std::vector<int> bitReverse;
+};
@@ -0,0 +1,42 @@
+#pragma once
+#include <cstring>
+
+// Copies between processing samples and the capture rings and frozen tables, which
+// hold the host's precision, or float in the rings shared between instances.
+namespace SampleFormat
+{
+    // Frozen tables hold interleaved frames of this many channels
+    constexpr int channelsPerFrame = 2;
+
+    inline float toFloat(float s) noexcept { return s; }
+    inline double toFloat(double s) noexcept { return s; }
+
+    template <typename T>
+    void write(T* dest, const T* src, int numSamples) noexcept
+    {
+        std::memcpy(dest, src, sizeof(T) * (size_t)numSamples);
+    }
+
+    template <typename T, typename Src>
+    void store(T& dest, Src s) noexcept { dest = (T)s; }
+
+    // Interleaves two channels into stereo frames, converting to the storage type
+    template <typename T, typename Src>
+    void interleave(T* dest, const Src* left, const Src* right, int numFrames) noexcept
+    {
+        for (int i = 0; i < numFrames; i++) {
+            store(dest[2 * i], left[i]);
+            store(dest[2 * i + 1], right[i]);
+        }
+    }
+
+    // Mixed precision, for the float rings shared between instances
+    inline void write(float* dest, const double* src, int numSamples) noexcept
+    {
+        for (int i = 0; i < numSamples; i++) dest[i] = (float)src[i];
+    }
+    inline void write(double* dest, const float* src, int numSamples) noexcept
+    {
+        for (int i = 0; i < numSamples; i++) dest[i] = src[i];
+    }
+}
@@ -0,0 +1,85 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <vector>
+#include "FixedDelayBuffer.h"
+#include "SampleFormat.h"
+
+// Stereo capture ring with one writer and any number of readers on other threads,
+// none of which ever wait. The writer announces the span it is about to overwrite
+// before touching it; a reader copies the frames it needs and then clears whatever
+// the writer announced in the meantime. Only the oldest samples can be hit, so a
+// frozen table never contains a torn block, at worst a few silent ones at its start.
+// Samples are relaxed atomics, since readers may load one while it is being stored.
+class SharedCaptureRing
+{
+public:
+    explicit SharedCaptureRing(int size = FixedDelayBuffer<float>::defaultSize)
+        : left((size_t)size), right((size_t)size)
+    {
+    }
+
+    int getSize() const noexcept { return (int)left.size(); }
+
+    // Writer thread only
+    template <typename Src>
+    void write(const Src* srcLeft, const Src* srcRight, int numSamples) noexcept
+    {
+        int size = getSize();
+        if (numSamples > size) {
+            srcLeft += numSamples - size;
+            srcRight += numSamples - size;
+            numSamples = size;
+        }
+        std::int64_t start = written.load(std::memory_order_relaxed);
+        claimed.store(start + numSamples, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        int index = (int)(start % size);
+        int first = std::min(numSamples, size - index);
+        store(left.data() + index, srcLeft, first);
+        store(left.data(), srcLeft + first, numSamples - first);
+        store(right.data() + index, srcRight, first);
+        store(right.data(), srcRight + first, numSamples - first);
+
+        written.store(start + numSamples, std::memory_order_release);
+    }
+
+    // Any thread. Copies stereo frames [first, last) of the ring, counted from the
+    // oldest, into the same frames of `frames`, interleaved and converted to T
+    template <typename T>
+    void copyOrdered(T* frames, int first, int last) const noexcept
+    {
+        int size = getSize();
+        std::int64_t end = written.load(std::memory_order_acquire);
+        int oldest = (int)(end % size);
+        int split = std::clamp(size - oldest, first, last);
+        load(frames + 2 * first, oldest + first, split - first);
+        load(frames + 2 * split, oldest + split - size, last - split);
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        std::int64_t overwritten = claimed.load(std::memory_order_relaxed) - end;
+        int stale = (int)std::min<std::int64_t>(overwritten, last);
+        if (stale > first) std::fill(frames + 2 * first, frames + 2 * stale, T());
+    }
+
+private:
+    template <typename Src>
+    static void store(std::atomic<float>* dest, const Src* src, int numSamples) noexcept
+    {
+        for (int i = 0; i < numSamples; i++) dest[i].store((float)src[i], std::memory_order_relaxed);
+    }
+
+    template <typename T>
+    void load(T* frames, int index, int numFrames) const noexcept
+    {
+        for (int i = 0; i < numFrames; i++) {
+            SampleFormat::store(frames[2 * i], left[(size_t)(index + i)].load(std::memory_order_relaxed));
+            SampleFormat::store(frames[2 * i + 1], right[(size_t)(index + i)].load(std::memory_order_relaxed));
+        }
+    }
+
+    std::vector<std::atomic<float>> left, right;
+    std::atomic<std::int64_t> written{ 0 };
+    std::atomic<std::int64_t> claimed{ 0 };
+};
@@ -0,0 +1,212 @@
+#include "SpectralFreeze.h"
+#include <cmath>
+
+static constexpr float twoPi = 6.28318530718f;
+
+SpectralFreeze::SpectralFreeze()
+{
+    for (int o = minOrder; o <= maxOrder; o++) {
+        int n = 1 << o;
+        ffts[o - minOrder] = std::make_unique<RealFft>(o);
+        auto& window = windows[o - minOrder];
+        window.resize((size_t)n);
+        for (int i = 0; i < n; i++)
+            window[(size_t)i] = 0.5f - 0.5f * std::cos(twoPi * i / n);
+    }
+
+    // Two spare zeroed bins past the end let interpolated lookups run off the top safely
+    size_t maxBins = maxSize / 2 + 3;
+    for (auto& channel : channels) {
+        for (auto* v : { &channel.fine, &channel.envelope, &channel.omega, &channel.phasorRe, &channel.phasorIm, &channel.rotationRe, &channel.rotationIm })
+            v->assign(maxBins, 0.f);
+        channel.output.assign(maxSize, 0.f);
+    }
+    captured.assign(maxSize + maxSize / overlap, 0.f);
+    fftData.assign(2 * maxSize, 0.f);
+    magnitudes.assign(maxBins, 0.f);
+    phases.assign(maxBins, 0.f);
+    previousPhases.assign(maxBins, 0.f);
+    pitchIndex.assign(maxBins, 0);
+    formantIndex.assign(maxBins, 0);
+    pitchFraction.assign(maxBins, 0.f);
+    formantFraction.assign(maxBins, 0.f);
+
+    randomRe.resize(maxBins);
+    randomIm.resize(maxBins);
+    CoreRandom tableRandom(0x1ceb0c5);
+    for (size_t k = 0; k < maxBins; k++) {
+        float phase = twoPi * tableRandom.nextFloat();
+        randomRe[k] = std::cos(phase);
+        randomIm[k] = std::sin(phase);
+    }
+}
+
+void SpectralFreeze::reset()
+{
+    for (auto& channel : channels)
+        std::fill(channel.output.begin(), channel.output.end(), 0.f);
+    readIndex = 0;
+}
+
+void SpectralFreeze::applySettings()
+{
+    order = pendingOrder;
+    size = 1 << order;
+    bins = size / 2 + 1;
+    hop = size / overlap;
+    phaseMode = pendingPhaseMode;
+    // Overlap-added Hann frames sum to 1.5 for coherent partials; random phases add in power instead
+    gain = phaseMode == vocoderPhase ? 2.f / 3 : 4.f / 3;
+}
+
+void SpectralFreeze::transform(const float* input, std::vector<float>& mags, std::vector<float>& phs)
+{
+    float* data = fftData.data();
+    const float* window = windows[order - minOrder].data();
+    for (int i = 0; i < size; i++) data[i] = input[i] * window[i];
+    std::fill(data + size, data + 2 * size, 0.f);
+    ffts[order - minOrder]->performRealOnlyForwardTransform(data);
+    for (int k = 0; k < bins; k++) {
+        float re = data[2 * k];
+        float im = data[2 * k + 1];
+        mags[(size_t)k] = std::sqrt(re * re + im * im);
+        phs[(size_t)k] = std::atan2(im, re);
+    }
+}
+
+void SpectralFreeze::analyse(Channel& channel)
+{
+    // Two frames one hop apart give each bin's true frequency from its phase advance
+    transform(captured.data(), magnitudes, previousPhases);
+    transform(captured.data() + hop, magnitudes, phases);
+    float binStep = twoPi / size;
+    for (int k = 0; k < bins; k++) {
+        float expected = binStep * k * hop;
+        float deviation = phases[(size_t)k] - previousPhases[(size_t)k] - expected;
+        deviation -= twoPi * std::round(deviation / twoPi);
+        channel.omega[(size_t)k] = binStep * k + deviation / hop;
+    }
+
+    // Moving average over a fixed fraction of the spectrum for the envelope
+    int radius = std::max(1, size / 512);
+    float sum = 0;
+    int count = 0;
+    for (int k = 0; k < std::min(radius, bins); k++, count++) sum += magnitudes[(size_t)k];
+    for (int k = 0; k < bins; k++) {
+        if (k + radius < bins) { sum += magnitudes[(size_t)(k + radius)]; count++; }
+        if (k - radius - 1 >= 0) { sum -= magnitudes[(size_t)(k - radius - 1)]; count--; }
+        float envelope = std::max(1.0e-9f, sum / count);
+        channel.envelope[(size_t)k] = envelope;
+        channel.fine[(size_t)k] = magnitudes[(size_t)k] / envelope;
+    }
+    for (int k = bins; k < bins + 2; k++) {
+        channel.envelope[(size_t)k] = channel.envelope[(size_t)(bins - 1)];
+        channel.fine[(size_t)k] = 0;
+        channel.omega[(size_t)k] = 0;
+    }
+
+    int offset = random.nextInt(bins);
+    for (int k = 0; k < bins; k++) {
+        if (phaseMode == vocoderPhase) {
+            channel.phasorRe[(size_t)k] = std::cos(phases[(size_t)k]);
+            channel.phasorIm[(size_t)k] = std::sin(phases[(size_t)k]);
+        }
+        else {
+            channel.phasorRe[(size_t)k] = randomRe[(size_t)((k + offset) % bins)];
+            channel.phasorIm[(size_t)k] = randomIm[(size_t)((k + offset) % bins)];
+        }
+    }
+
+    std::fill(channel.output.begin(), channel.output.end(), 0.f);
+    readIndex = hop;
+    lastPitch = 0;
+    framesSinceNormalise = 0;
+}
+
+void SpectralFreeze::updateRotations(Channel& channel, float pitch) noexcept
+{
+    for (int k = 0; k < bins; k++) {
+        int i = pitchIndex[(size_t)k];
+        float t = pitchFraction[(size_t)k];
+        float omega = channel.omega[(size_t)i] + t * (channel.omega[(size_t)(i + 1)] - channel.omega[(size_t)i]);
+        float advance = omega * pitch * hop;
+        channel.rotationRe[(size_t)k] = std::cos(advance);
+        channel.rotationIm[(size_t)k] = std::sin(advance);
+    }
+}
+
+void SpectralFreeze::synthesise(float pitch, float formant) noexcept
+{
+    // Source bins for the shifted fine structure and the warped envelope
+    float inversePitch = 1 / std::max(pitch, 1.0e-3f);
+    float inverseFormant = 1 / std::max(formant, 1.0e-3f);
+    for (int k = 0; k < bins; k++) {
+        float p = std::min(k * inversePitch, (float)bins);
+        float f = std::min(k * inverseFormant, (float)bins);
+        pitchIndex[(size_t)k] = (int)p;
+        pitchFraction[(size_t)k] = p - (int)p;
+        formantIndex[(size_t)k] = (int)f;
+        formantFraction[(size_t)k] = f - (int)f;
+    }
+
+    bool vocoder = phaseMode == vocoderPhase;
+    if (vocoder && pitch != lastPitch) {
+        for (auto& channel : channels)
+            updateRotations(channel, pitch);
+        lastPitch = pitch;
+    }
+
+    float* data = fftData.data();
+    for (auto& channel : channels) {
+        float* re = channel.phasorRe.data();
+        float* im = channel.phasorIm.data();
+        if (vocoder) {
+            const float* cr = channel.rotationRe.data();
+            const float* ci = channel.rotationIm.data();
+            for (int k = 0; k < bins; k++) {
+                float r = re[k] * cr[k] - im[k] * ci[k];
+                im[k] = re[k] * ci[k] + im[k] * cr[k];
+                re[k] = r;
+            }
+        }
+        else {
+            int offset = random.nextInt(bins);
+            int first = bins - offset;
+            std::copy(randomRe.begin() + offset, randomRe.begin() + bins, re);
+            std::copy(randomRe.begin(), randomRe.begin() + offset, re + first);
+            std::copy(randomIm.begin() + offset, randomIm.begin() + bins, im);
+            std::copy(randomIm.begin(), randomIm.begin() + offset, im + first);
+        }
+
+        const float* fine = channel.fine.data();
+        const float* envelope = channel.envelope.data();
+        for (int k = 0; k < bins; k++) {
+            int i = pitchIndex[(size_t)k];
+            int j = formantIndex[(size_t)k];
+            float m = fine[i] + pitchFraction[(size_t)k] * (fine[i + 1] - fine[i]);
+            m *= envelope[j] + formantFraction[(size_t)k] * (envelope[j + 1] - envelope[j]);
+            data[2 * k] = m * gain * re[k];
+            data[2 * k + 1] = m * gain * im[k];
+        }
+        std::fill(data + 2 * bins, data + 2 * size, 0.f);
+        ffts[order - minOrder]->performRealOnlyInverseTransform(data);
+
+        float* output = channel.output.data();
+        std::copy(output + hop, output + size, output);
+        std::fill(output + size - hop, output + size, 0.f);
+        const float* window = windows[order - minOrder].data();
+        for (int i = 0; i < size; i++) output[i] += data[i] * window[i];
+    }
+
+    // Repeated rotation slowly drifts the phasors off the unit circle
+    if (vocoder && ++framesSinceNormalise >= 64) {
+        for (auto& channel : channels) {
+            for (int k = 0; k < bins; k++) {
+                float scale = 1 / std::sqrt(channel.phasorRe[(size_t)k] * channel.phasorRe[(size_t)k] + channel.phasorIm[(size_t)k] * channel.phasorIm[(size_t)k]);
+                channel.phasorRe[(size_t)k] *= scale;
+                channel.phasorIm[(size_t)k] *= scale;
+            }
+        }
+        framesSinceNormalise = 0;
+    }
+}
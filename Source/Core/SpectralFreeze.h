@@ -0,0 +1,108 @@
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "CoreRandom.h"
+#include "RealFft.h"
+#include "SampleFormat.h"
+
+// Spectral alternative to looping a single cycle. At note-on the window ending at
+// the freeze point is analysed into a fine structure, a smoothed spectral envelope
+// and per-bin frequencies; render() resynthesises it by overlap-add, shifting the
+// fine structure for pitch and warping the envelope for formant. Every buffer is
+// sized for the largest FFT up front, so changing size never allocates.
+class SpectralFreeze
+{
+public:
+    static constexpr int minOrder = 10;
+    static constexpr int maxOrder = 13;
+    static constexpr int maxSize = 1 << maxOrder;
+    static constexpr int overlap = 4;
+    static constexpr int numSizes = maxOrder - minOrder + 1;
+    enum PhaseMode { randomPhase, vocoderPhase, numPhaseModes };
+
+    static constexpr const char* sizeNames[numSizes] = { "1024", "2048", "4096", "8192" };
+    static constexpr const char* phaseNames[numPhaseModes] = { "Random", "Vocoder" };
+
+    SpectralFreeze();
+
+    // Both take effect at the next capture
+    void setOrder(int newOrder) { pendingOrder = std::clamp(newOrder, minOrder, maxOrder); }
+    void setPhaseMode(int mode) { pendingPhaseMode = mode; }
+    void setSeed(std::int64_t seed) { random.setSeed(seed); }
+    void reset();
+
+    // Analyses the window of the frozen stereo frames that ends at frame `end`, reading
+    // nothing before frame `start`; a window longer than the frames is zero-padded
+    template <typename S>
+    void capture(const S* frames, int start, int end)
+    {
+        applySettings();
+        start = std::max(start, end - size - hop);
+        int available = std::clamp(end - start, 0, size + hop);
+        for (int c = 0; c < 2; c++) {
+            const S* table = frames + 2 * start + c;
+            for (int i = 0; i < available; i++)
+                captured[(size_t)i] = SampleFormat::toFloat(table[2 * i]);
+            std::fill(captured.begin() + available, captured.begin() + size + hop, 0.f);
+            analyse(channels[c]);
+        }
+    }
+
+    template <typename T>
+    void render(T* left, T* right, int numSamples, float pitch, float formant) noexcept
+    {
+        for (int i = 0; i < numSamples;) {
+            if (readIndex >= hop) {
+                synthesise(pitch, formant);
+                readIndex = 0;
+            }
+            int n = std::min(numSamples - i, hop - readIndex);
+            const float* outL = channels[0].output.data() + readIndex;
+            const float* outR = channels[1].output.data() + readIndex;
+            for (int j = 0; j < n; j++) {
+                left[i + j] = (T)outL[j];
+                right[i + j] = (T)outR[j];
+            }
+            readIndex += n;
+            i += n;
+        }
+    }
+
+private:
+    struct Channel
+    {
+        std::vector<float> fine, envelope, omega;
+        std::vector<float> phasorRe, phasorIm, rotationRe, rotationIm;
+        std::vector<float> output;
+    };
+
+    void applySettings();
+    void analyse(Channel& channel);
+    void transform(const float* input, std::vector<float>& magnitudes, std::vector<float>& phases);
+    void synthesise(float pitch, float formant) noexcept;
+    void updateRotations(Channel& channel, float pitch) noexcept;
+
+    std::unique_ptr<RealFft> ffts[numSizes];
+    std::vector<float> windows[numSizes];
+    Channel channels[2];
+
+    std::vector<float> captured, fftData, magnitudes, phases, previousPhases;
+    std::vector<float> randomRe, randomIm;
+    std::vector<int> pitchIndex, formantIndex;
+    std::vector<float> pitchFraction, formantFraction;
+
+    CoreRandom random;
+    int order = 11;
+    int pendingOrder = 11;
+    int size = 1 << 11;
+    int bins = (1 << 10) + 1;
+    int hop = (1 << 11) / overlap;
+    int phaseMode = randomPhase;
+    int pendingPhaseMode = randomPhase;
+    int readIndex = 0;
+    int framesSinceNormalise = 0;
+    float gain = 1;
+    float lastPitch = 0;
+};
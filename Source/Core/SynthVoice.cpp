@@ -0,0 +1,681 @@
+#include "SynthVoice.h"
+#include "PitchMath.h"
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+void SynthVoice::startNote(int midiNoteNumber, float velocity, int currentPitchWheelPosition)
+{
+    currentNote = midiNoteNumber;
+    frequencyTarget = PitchMath::noteToHz(midiNoteNumber);
+    if (frequencyInit) {
+        frequency = frequencyTarget;
+        frequencyInit = false;
+    }
+    portamentoBase = frequency;
+    mod.setSourceValue(ModMatrix::velocity, velocity);
+
+    // Overlapping notes in legato mode keep the frozen table and envelope and only glide
+    if (legatoHandoff) {
+        legatoHandoff = false;
+        return;
+    }
+
+    formant = formantBase;
+    refreeze();
+
+    controlCountdown = 0;
+    adsr.noteOn();
+}
+
+void SynthVoice::refreeze()
+{
+    if (doublePrecision) freeze(doubleTables);
+    else freeze(floatTables);
+}
+
+template <typename T>
+void SynthVoice::freeze(FreezeTables<T>& tables)
+{
+    // The rolls already hold the whole block, so reach back to the note-on sample
+    // and, when synced, further back to the last grid line (at most half the roll)
+    int delay = blockSize - blockPosition;
+    if (sync.enabled && sync.gridSamples > 0)
+        delay += (int)std::fmod(sync.samplesSinceGrid + blockPosition, sync.gridSamples);
+    int size = tables.numFrames;
+    tableEnd = (float)std::clamp(size - delay, size / 2, size);
+    float regionStart = sync.regionSamples > 0 ? std::max(0.f, tableEnd - (float)sync.regionSamples) : 0.f;
+    tableStart = regionStart;
+
+    // Nothing reads before the synced region or more than a frame past the freeze
+    // point, so only that much is copied from a shared ring
+    T* frames = tables.frames.data();
+    if (captureSource != nullptr) captureSource->copyOrdered(frames, (int)tableStart, std::min(size, (int)std::ceil(tableEnd) + 2));
+    else {
+        tables.leftRoll.copyOrdered(frames, FreezeTables<T>::channels);
+        tables.rightRoll.copyOrdered(frames + 1, FreezeTables<T>::channels);
+    }
+    tables.updateGuardFrame();
+
+    cycleLength = clampCycle(getSampleRate() * formant * modFormant / frequency);
+    position = tableEnd - cycleLength;
+    cacheLength = 0;
+    grains.reset(size, regionStart, tableEnd, cycleLength);
+    if (spectral) spectrum.capture(frames, (int)tableStart, (int)tableEnd);
+
+    // Only the part of the table that will be heard is measured: the synced region or,
+    // for grains, the region they draw from; otherwise the cycle the loop starts on
+    measureLevel(tables, granular || sync.regionSamples > 0 ? regionStart : (float)position);
+}
+
+// The rolls keep block statistics as they are written, so this reads block records
+// and scans only the partial blocks at the ends; frames frozen from a shared ring
+// have none and are scanned
+template <typename T>
+void SynthVoice::measureLevel(const FreezeTables<T>& tables, float start)
+{
+    levelGain = 1;
+    dcLeft = dcRight = 0;
+    if (levelMode == levelOff) return;
+
+    using Stats = typename FixedDelayBuffer<T>::Stats;
+    Stats left, right;
+    int end = (int)tableEnd;
+    int first = std::clamp((int)start, 0, end);
+    if (tables.leftRoll.getSize() > 0) {
+        int delay = tables.numFrames - end;
+        left = tables.leftRoll.getRecentStats(end - first, delay);
+        right = tables.rightRoll.getRecentStats(end - first, delay);
+    }
+    else {
+        const T* frame = tables.frames.data();
+        for (int i = first; i < end; i++) {
+            double l = SampleFormat::toFloat(frame[2 * i]);
+            double r = SampleFormat::toFloat(frame[2 * i + 1]);
+            left.sum += l;
+            left.squares += l * l;
+            left.peak = std::max(left.peak, (float)std::abs(l));
+            right.sum += r;
+            right.squares += r * r;
+            right.peak = std::max(right.peak, (float)std::abs(r));
+        }
+        left.count = right.count = end - first;
+    }
+    if (left.count == 0 || right.count == 0) return;
+
+    double meanLeft = left.sum / left.count;
+    double meanRight = right.sum / right.count;
+    dcLeft = (float)meanLeft;
+    dcRight = (float)meanRight;
+    if (levelMode != levelNormalize) return;
+
+    // Power around the mean, averaged over both channels; the gain is also held down
+    // far enough that the loudest sample, once centred, stays below full scale
+    double power = 0.5 * (left.squares / left.count - meanLeft * meanLeft + right.squares / right.count - meanRight * meanRight);
+    float rms = (float)std::sqrt(std::max(0.0, power));
+    if (rms < 1.0e-5f) return;
+    float peak = std::max(left.peak + std::abs(dcLeft), right.peak + std::abs(dcRight));
+    levelGain = std::min({ normalizeTarget / rms, maxNormalizeGain, 0.99f / peak });
+}
+
+template <typename T>
+void SynthVoice::applyLevel(T* wetL, T* wetR, int numSamples, bool removeDc) const noexcept
+{
+    T offsetL = removeDc ? (T)dcLeft : T();
+    T offsetR = removeDc ? (T)dcRight : T();
+    T gain = (T)levelGain;
+    for (int i = 0; i < numSamples; i++) {
+        wetL[i] = (wetL[i] - offsetL) * gain;
+        wetR[i] = (wetR[i] - offsetR) * gain;
+    }
+}
+
+void SynthVoice::stopNote(float velocity, bool allowTailOff)
+{
+    if (allowTailOff) adsr.noteOff();
+    else {
+        // The synth hard-stops a held note right before stealing the voice for the next
+        // one; in legato mode the envelope survives until the next render in case it is
+        legatoHandoff = legato && isKeyDown() && adsr.isActive();
+        if (!legatoHandoff) adsr.reset();
+        clearCurrentNote();
+    }
+}
+
+void SynthVoice::controllerMoved(int controllerNumber, int newControllerValue)
+{
+    if (controllerNumber == modController) mod.setSourceValue(ModMatrix::controller, newControllerValue / 127.f);
+
+    if (controllerNumber == refreezeController && refreezeController > 0) {
+        bool held = newControllerValue >= 64;
+        if (held && !refreezeHeld && adsr.isActive()) refreeze();
+        refreezeHeld = held;
+    }
+}
+
+void SynthVoice::aftertouchChanged(int newAftertouchValue)
+{
+    mod.setSourceValue(ModMatrix::aftertouch, newAftertouchValue / 127.f);
+}
+
+void SynthVoice::channelPressureChanged(int newChannelPressureValue)
+{
+    mod.setSourceValue(ModMatrix::aftertouch, newChannelPressureValue / 127.f);
+}
+
+void SynthVoice::pitchWheelMoved(int newPitchWheelValue)
+{
+    pWheel = PitchMath::pitchWheelToRatio(newPitchWheelValue);
+}
+
+void SynthVoice::prepareToPlay(double sampleRate, int samplesPerBlock, int outputChannels, bool useDoublePrecision)
+{
+    setStorage(useDoublePrecision, captureSource);
+
+    adsr.setSampleRate(sampleRate);
+    adsr.reset();
+    grains.prepare(sampleRate);
+    mod.prepare(sampleRate);
+    controlCountdown = 0;
+
+    isPrepared = true;
+}
+
+// Reallocates the capture storage; must not run concurrently with rendering. With a
+// source the voice freezes from that ring and capture() is not called.
+void SynthVoice::setStorage(bool useDoublePrecision, const SharedCaptureRing* source)
+{
+    doublePrecision = useDoublePrecision;
+    captureSource = source;
+    int size = FixedDelayBuffer<float>::defaultSize;
+    assert(source == nullptr || source->getSize() == size);
+    int rollSize = source != nullptr ? 0 : size;
+    floatTables.setSize(doublePrecision ? 0 : size, doublePrecision ? 0 : rollSize);
+    doubleTables.setSize(doublePrecision ? size : 0, doublePrecision ? rollSize : 0);
+    floatCache.setSize(doublePrecision ? 0 : loopCacheSize);
+    doubleCache.setSize(doublePrecision ? loopCacheSize : 0);
+    cacheLength = 0;
+}
+
+// Returns the voice to its freshly prepared state so identical input renders identically
+void SynthVoice::resetState()
+{
+    adsr.reset();
+    legatoHandoff = false;
+    refreezeHeld = false;
+    clearCurrentNote();
+    floatTables.leftRoll.writeSilence(floatTables.leftRoll.getSize());
+    floatTables.rightRoll.writeSilence(floatTables.rightRoll.getSize());
+    doubleTables.leftRoll.writeSilence(doubleTables.leftRoll.getSize());
+    doubleTables.rightRoll.writeSilence(doubleTables.rightRoll.getSize());
+
+    frequencyInit = true;
+    formant = formantBase;
+    pWheel = 1;
+    position = 0;
+    cacheLength = 0;
+
+    mod.resetPhases();
+    controlCountdown = 0;
+    modFormant = 1;
+    modFormantStep = 0;
+    modTarget = 1;
+    modTargetStep = 0;
+    wetGain = wet;
+    wetGainStep = 0;
+    dryGain = dry;
+    dryGainStep = 0;
+
+    grains.setSeed(0);
+    spectrum.setSeed(0);
+    spectrum.reset();
+}
+
+// Position, index and fraction are worked out once for both channels. Callers keep
+// the position inside the table.
+template <typename T, typename S>
+void SynthVoice::readFrame(const FreezeTables<S>& tables, double pos, T& left, T& right) noexcept
+{
+    assert(pos >= 0 && pos < tables.numFrames);
+    int lower = (int)pos;
+    T t = (T)(pos - lower);
+    const S* frame = tables.frames.data() + (size_t)lower * FreezeTables<S>::channels;
+    T l0 = (T)SampleFormat::toFloat(frame[0]);
+    T r0 = (T)SampleFormat::toFloat(frame[1]);
+    T l1 = (T)SampleFormat::toFloat(frame[2]);
+    T r1 = (T)SampleFormat::toFloat(frame[3]);
+    left = l0 + t * (l1 - l0);
+    right = r0 + t * (r1 - r0);
+}
+
+void SynthVoice::formantChanged(float newFormant)
+{
+    float oldBase = formantBase;
+    formantBase = PitchMath::semitonesToRatio(newFormant);
+    formant = formant * formantBase / oldBase;
+    formantTarget = formantTarget * formantBase / oldBase;
+    cycleLength = clampCycle(getSampleRate() * formant / frequency);
+}
+
+// A read head that has passed the end of the loop goes back by whole cycles. A
+// short synced region can leave the cycle shorter than one step, so a single
+// subtraction isn't always enough.
+double SynthVoice::wrapLoop(double pos, double end, double cycle) noexcept
+{
+    return pos < end ? pos : end - cycle + std::fmod(pos - end, cycle);
+}
+
+// A low note with a high formant can ask for a cycle longer than the frozen part of
+// the table, which would put the read head before its start
+float SynthVoice::clampCycle(double samples) const noexcept
+{
+    return (float)std::min(samples, std::max(1.0, (double)tableEnd - tableStart - 1.0));
+}
+
+void SynthVoice::formantEnvelopeChanged(float depth, float newRate, bool linear) {
+    float tempTarget = formantBase * PitchMath::semitonesToRatio(depth);
+    if (tempTarget / frequency * sampleRate > PitchMath::noteToHz(0)) formantTarget = tempTarget;
+    else formantTarget = PitchMath::noteToHz(0);
+    formantRate = 1 - (0.0001 * newRate);
+    exp = !linear;
+}
+
+void SynthVoice::adsrChanged(float a, float d, float s, float r, float curve) {
+    adsr.setParameters(a, d, s, r);
+    adsr.setCurve(curve);
+}
+
+void SynthVoice::portamentoChanged(float p) {
+    portamentoAmount = p;
+    usePortamento = (p < 1);
+    portamento = 1 - (0.001 * p);
+}
+
+void SynthVoice::wetDryChanged(float w, float d) {
+    wet = w;
+    dry = d;
+}
+
+void SynthVoice::granularChanged(bool enabled, int numGrains, float length, float jitter, float spread) {
+    granular = enabled;
+    grains.setNumGrains(numGrains);
+    grains.setGrainLength(length);
+    grains.setJitter(jitter);
+    grains.setFormantSpread(spread);
+}
+
+void SynthVoice::blockStarted(int numSamples, const FreezeSync& newSync) {
+    blockSize = numSamples;
+    blockPosition = 0;
+    sync = newSync;
+}
+
+void SynthVoice::modulationChanged(int slot, int source, int destination, float amount) {
+    mod.setSlot(slot, source, destination, amount);
+}
+
+void SynthVoice::lfoChanged(int index, float rate, int shape) {
+    mod.setLfo(index, rate, shape);
+}
+
+void SynthVoice::modControllerChanged(int controllerNumber) {
+    modController = controllerNumber;
+}
+
+// Size and phase mode apply from the next freeze
+void SynthVoice::spectralChanged(bool enabled, int sizeIndex, int phaseMode) {
+    spectral = enabled;
+    spectrum.setOrder(SpectralFreeze::minOrder + sizeIndex);
+    spectrum.setPhaseMode(phaseMode);
+}
+
+// Applies from the next freeze
+void SynthVoice::levelChanged(int mode) {
+    levelMode = mode;
+}
+
+// Copies the stretch of the frozen table the read head cycles through, as interleaved
+// float frames with the freeze level correction applied, plus a frame before and two
+// after for interpolation. loopStart is where the cycle begins within the copy.
+// Returns the number of frames copied, or 0 when no note is sounding.
+int SynthVoice::copyLoop(float* frames, int maxFrames, double& loopStart, double& loopLength) const noexcept
+{
+    if (!isVoiceActive()) return 0;
+    if (doublePrecision) return copyLoopFrom(doubleTables, frames, maxFrames, loopStart, loopLength);
+    return copyLoopFrom(floatTables, frames, maxFrames, loopStart, loopLength);
+}
+
+template <typename T>
+int SynthVoice::copyLoopFrom(const FreezeTables<T>& tables, float* dest, int maxFrames, double& loopStart, double& loopLength) const noexcept
+{
+    if (tables.numFrames == 0) return 0;
+    double start = std::max(0.0, (double)tableEnd - cycleLength);
+    int first = std::max((int)tableStart, (int)start - 1);
+    int last = std::min(tables.numFrames, (int)std::ceil(tableEnd) + 2);
+    int count = std::min(last - first + 1, maxFrames);
+
+    const T* frame = tables.frames.data() + (size_t)first * FreezeTables<T>::channels;
+    for (int i = 0; i < count; i++) {
+        dest[2 * i] = (SampleFormat::toFloat(frame[2 * i]) - dcLeft) * levelGain;
+        dest[2 * i + 1] = (SampleFormat::toFloat(frame[2 * i + 1]) - dcRight) * levelGain;
+    }
+    loopStart = start - first;
+    loopLength = tableEnd - start;
+    return count;
+}
+
+// Controller 0 disables the refreeze trigger
+void SynthVoice::legatoChanged(bool enabled, int controllerNumber) {
+    legato = enabled;
+    refreezeController = controllerNumber;
+}
+
+// Evaluated every ModMatrix::controlInterval samples; the render loop ramps towards the results
+void SynthVoice::updateModulation()
+{
+    mod.advance(ModMatrix::controlInterval);
+    float interval = ModMatrix::controlInterval;
+
+    // Formant routings are scaled to +/- 24 semitones at full depth
+    float newFormant = PitchMath::fastExp2(mod.getOutput(ModMatrix::formant) * 2);
+    float newTarget = PitchMath::fastExp2(mod.getOutput(ModMatrix::formantTarget) * 2);
+    float newWet = std::clamp(wet + mod.getOutput(ModMatrix::wet), 0.f, 1.f);
+    float newDry = std::clamp(dry + mod.getOutput(ModMatrix::dry), 0.f, 1.f);
+
+    modFormantStep = (newFormant - modFormant) / interval;
+    modTargetStep = (newTarget - modTarget) / interval;
+    wetGainStep = (newWet - wetGain) / interval;
+    dryGainStep = (newDry - dryGain) / interval;
+
+    float p = std::clamp(portamentoAmount + mod.getOutput(ModMatrix::portamento), 0.f, 1.f);
+    usePortamento = (p < 1);
+    portamento = 1 - (0.001 * p);
+
+    controlCountdown = ModMatrix::controlInterval;
+}
+
+float SynthVoice::expDecay(float now, float targ, float rate, float sRate)
+{
+    return targ + ((now - targ) * rate);
+}
+
+float SynthVoice::linDecay(float base, float now, float targ, float rate, float sRate)
+{
+    float delta = (base - targ) * (1 - rate) * 19200 / sRate;
+    if (delta >= 0) { // Decreasing
+        return (now - delta < targ) ? targ : (now - delta);
+    }
+    else { // Increasing
+        return (now - delta > targ) ? targ : (now - delta);
+    }
+}
+
+float SynthVoice::linDecayBlock(float base, float now, float targ, float rate, float sRate, int numSamples)
+{
+    float delta = (base - targ) * (1 - rate) * 19200 / sRate * numSamples;
+    if (delta >= 0) { // Decreasing
+        return (now - delta < targ) ? targ : (now - delta);
+    }
+    else { // Increasing
+        return (now - delta > targ) ? targ : (now - delta);
+    }
+}
+
+// Advances the glides over numSamples in closed form without rendering anything
+void SynthVoice::skipSamples(int numSamples)
+{
+    if (usePortamento) frequency = linDecayBlock(portamentoBase, frequency, frequencyTarget * pWheel, portamento, getSampleRate(), numSamples);
+    else frequency = frequencyTarget * pWheel;
+
+    if (exp) formant = formantTarget * modTarget + (formant - formantTarget * modTarget) * std::pow(formantRate, (float)numSamples);
+    else formant = linDecayBlock(formantBase, formant, formantTarget * modTarget, formantRate, getSampleRate(), numSamples);
+
+    cycleLength = clampCycle(getSampleRate() * formant * modFormant / frequency);
+}
+
+// No note sounding: the output is just the input at the dry gain
+template <typename T>
+void SynthVoice::renderIdle(T* outL, T* outR, int numSamples)
+{
+    mod.advance(numSamples);
+    float newDry = std::clamp(dry + mod.getOutput(ModMatrix::dry), 0.f, 1.f);
+
+    if (dryGain == 0 && newDry == 0) {
+        std::fill(outL, outL + numSamples, T());
+        std::fill(outR, outR + numSamples, T());
+    }
+    else if (dryGain != 1 || newDry != 1) {
+        T step = ((T)newDry - (T)dryGain) / numSamples;
+        for (int i = 0; i < numSamples; i++) {
+            T gain = (T)dryGain + step * i;
+            outL[i] *= gain;
+            outR[i] *= gain;
+        }
+    }
+
+    dryGain = newDry;
+    dryGainStep = 0;
+    controlCountdown = 0;
+    skipSamples(numSamples);
+}
+
+// Advances the read head (or grains) and the glides, writing the frozen signal
+template <typename T, typename S>
+void SynthVoice::renderFrozen(const FreezeTables<S>& tables, T* wetL, T* wetR, int numSamples)
+{
+    // The spectral engine works a hop at a time, so its pitch and formant follow at control rate
+    if (spectral) {
+        modFormant += modFormantStep * numSamples;
+        modTarget += modTargetStep * numSamples;
+        skipSamples(numSamples);
+        spectrum.render(wetL, wetR, numSamples, frequency / PitchMath::noteToHz(60), formant * modFormant);
+        // Resynthesis leaves no DC to remove
+        if (levelMode == levelNormalize) applyLevel(wetL, wetR, numSamples, false);
+        return;
+    }
+
+    auto& cache = getLoopCache(T());
+    if (!cache.left.empty() && updateLoopCache()) {
+        renderLoopCache(tables, cache, wetL, wetR, numSamples);
+        if (levelMode != levelOff) applyLevel(wetL, wetR, numSamples, true);
+        return;
+    }
+
+    for (int i = 0; i < numSamples; i++) {
+        modFormant += modFormantStep;
+        modTarget += modTargetStep;
+        float readRate = formant * modFormant;
+
+        if (granular) {
+            grains.renderSample(tables.frames.data(), readRate, cycleLength, wetL[i], wetR[i]);
+        }
+        else {
+            readFrame(tables, position, wetL[i], wetR[i]);
+        }
+
+        if (usePortamento) frequency = linDecay(portamentoBase, frequency, frequencyTarget * pWheel, portamento, getSampleRate());
+        else frequency = frequencyTarget * pWheel;
+
+        if (exp) formant = expDecay(formant, formantTarget * modTarget, formantRate, getSampleRate());
+        else formant = linDecay(formantBase, formant, formantTarget * modTarget, formantRate, getSampleRate());
+
+        readRate = formant * modFormant;
+        cycleLength = clampCycle(getSampleRate() * readRate / frequency);
+
+        position = wrapLoop(position + readRate, tableEnd, cycleLength);
+    }
+
+    if (levelMode != levelOff) applyLevel(wetL, wetR, numSamples, true);
+}
+
+// True when another sample of the glides would leave every one of them where it is
+bool SynthVoice::isSteady() const noexcept
+{
+    if (modFormant + modFormantStep != modFormant || modTarget + modTargetStep != modTarget) return false;
+
+    float nextFrequency = frequencyTarget * pWheel;
+    if (usePortamento) nextFrequency = linDecay(portamentoBase, frequency, frequencyTarget * pWheel, portamento, getSampleRate());
+    float nextFormant = exp ? expDecay(formant, formantTarget * modTarget, formantRate, getSampleRate())
+                            : linDecay(formantBase, formant, formantTarget * modTarget, formantRate, getSampleRate());
+    return nextFrequency == frequency && nextFormant == formant;
+}
+
+// Returns true when this chunk can come from the loop cache, starting a new one
+// when the voice has settled on different values
+bool SynthVoice::updateLoopCache() noexcept
+{
+    float readRate = formant * modFormant;
+    float cycle = clampCycle(getSampleRate() * readRate / frequency);
+    if (granular || !isSteady()) {
+        leaveLoopCache();
+        return false;
+    }
+    if (cacheLength > 0 && readRate == cacheReadRate && cycle == cacheCycle) return true;
+    leaveLoopCache();
+
+    // Not until the read head has reached the loop, or the first lap wouldn't repeat
+    if (position < tableEnd - cycle) return false;
+
+    // The whole number of cycles that comes closest to a whole number of samples
+    double samplesPerCycle = (double)cycle / readRate;
+    double bestError = 1;
+    int bestCycles = 0;
+    for (int cycles = 1; cycles * samplesPerCycle <= loopCacheSize; cycles++) {
+        double length = cycles * samplesPerCycle;
+        double error = std::abs(std::round(length) - length) / length;
+        if (error < bestError) {
+            bestError = error;
+            bestCycles = cycles;
+        }
+    }
+    if (bestCycles == 0) return false;
+
+    cacheLength = std::max(1, (int)std::round(bestCycles * samplesPerCycle));
+    cacheRate = bestCycles * (double)cycle / cacheLength;
+    cacheReadRate = readRate;
+    cacheCycle = cycle;
+    cycleLength = cycle;
+    cacheStart = cacheFillPosition = position;
+    cacheFilled = 0;
+    cacheIndex = 0;
+    return true;
+}
+
+// Picks the read head up where the cache had got to
+void SynthVoice::leaveLoopCache() noexcept
+{
+    if (cacheLength == 0) return;
+    double loopStart = tableEnd - cacheCycle;
+    position = loopStart + std::fmod(cacheStart - loopStart + cacheIndex * cacheRate, (double)cacheCycle);
+    cacheLength = 0;
+}
+
+// The first lap is read from the table as it is needed; after that it's a copy
+template <typename T, typename S>
+void SynthVoice::renderLoopCache(const FreezeTables<S>& tables, LoopCache<T>& cache, T* wetL, T* wetR, int numSamples) noexcept
+{
+    for (int done = 0; done < numSamples;) {
+        int n = std::min(numSamples - done, cacheLength - cacheIndex);
+        for (; cacheFilled < cacheIndex + n; cacheFilled++) {
+            readFrame(tables, cacheFillPosition, cache.left[(size_t)cacheFilled], cache.right[(size_t)cacheFilled]);
+            cacheFillPosition = wrapLoop(cacheFillPosition + cacheRate, tableEnd, cacheCycle);
+        }
+        std::copy(cache.left.begin() + cacheIndex, cache.left.begin() + cacheIndex + n, wetL + done);
+        std::copy(cache.right.begin() + cacheIndex, cache.right.begin() + cacheIndex + n, wetR + done);
+        cacheIndex += n;
+        if (cacheIndex == cacheLength) cacheIndex = 0;
+        done += n;
+    }
+}
+
+// The dry input fades out as the envelope fades the frozen signal in, so note
+// boundaries crossfade instead of switching. Gains ramp linearly across the chunk,
+// and each envelope piece gets its own loop with its formula worked out inline.
+template <typename T, typename Env>
+static void mixWetDry(T* outL, T* outR, const T* wetL, const T* wetR, int offset, int numSamples,
+    float wetStart, float wetStep, float dryStart, float dryStep, Env env) noexcept
+{
+    for (int i = offset; i < offset + numSamples; i++) {
+        float e = env(i - offset);
+        T wetGain = (T)(wetStart + wetStep * (i + 1)) * e;
+        T dryGain = (T)(dryStart + dryStep * (i + 1)) * (1 - e);
+        outL[i] = outL[i] * dryGain + wetL[i] * wetGain;
+        outR[i] = outR[i] * dryGain + wetR[i] * wetGain;
+    }
+}
+
+template <typename T>
+static void mixWetDry(T* outL, T* outR, const T* wetL, const T* wetR, int offset, const Envelope::Piece& piece,
+    float wetStart, float wetStep, float dryStart, float dryStep) noexcept
+{
+    float level = piece.level, slope = piece.slope, target = piece.target, distance = piece.distance;
+    const float* powers = piece.powers;
+    auto mix = [&](auto env) { mixWetDry(outL, outR, wetL, wetR, offset, piece.length, wetStart, wetStep, dryStart, dryStep, env); };
+
+    switch (piece.shape) {
+        case Envelope::Piece::flat: mix([level](int) { return level; }); break;
+        case Envelope::Piece::ramp: mix([level, slope](int j) { return level + slope * (j + 1); }); break;
+        case Envelope::Piece::curve: mix([target, distance, powers](int j) { return target + distance * powers[j]; }); break;
+    }
+}
+
+void SynthVoice::renderNextBlock(float* left, float* right, int startSample, int numSamples)
+{
+    renderBlock(left, right, startSample, numSamples);
+}
+
+void SynthVoice::renderNextBlock(double* left, double* right, int startSample, int numSamples)
+{
+    renderBlock(left, right, startSample, numSamples);
+}
+
+template <typename T>
+void SynthVoice::renderBlock(T* outL, T* outR, int startSample, int numSamples)
+{
+    assert(isPrepared);
+    blockPosition = startSample + numSamples;
+    if (legatoHandoff) {
+        // No note followed the hard stop, so finish it
+        legatoHandoff = false;
+        adsr.reset();
+    }
+    if (!adsr.isActive()) {
+        renderIdle(outL + startSample, outR + startSample, numSamples);
+        return;
+    }
+
+    // Both gains fully closed: only the envelope and glides need to move on
+    if (wet == 0 && dry == 0 && wetGain == 0 && dryGain == 0 && !mod.isRouted(ModMatrix::wet) && !mod.isRouted(ModMatrix::dry)) {
+        std::fill(outL + startSample, outL + startSample + numSamples, T());
+        std::fill(outR + startSample, outR + startSample + numSamples, T());
+        adsr.skip(numSamples);
+        skipSamples(numSamples);
+        if (!adsr.isActive()) clearCurrentNote();
+        return;
+    }
+
+    alignas(16) T wetL[ModMatrix::controlInterval];
+    alignas(16) T wetR[ModMatrix::controlInterval];
+
+    // Work in control-rate chunks: generate the frozen signal, then mix both
+    // channels in one pass per envelope piece, computing the envelope as it goes
+    for (int samp = startSample; samp < startSample + numSamples;) {
+        if (controlCountdown <= 0) updateModulation();
+        int n = std::min(controlCountdown, startSample + numSamples - samp);
+        float wetStart = wetGain;
+        float dryStart = dryGain;
+
+        renderFrozen(getTables(T()), wetL, wetR, n);
+
+        adsr.render(n, [&](int offset, const Envelope::Piece& piece) {
+            mixWetDry(outL + samp, outR + samp, wetL, wetR, offset, piece, wetStart, wetGainStep, dryStart, dryGainStep);
+        });
+
+        wetGain = wetStart + wetGainStep * n;
+        dryGain = dryStart + dryGainStep * n;
+        controlCountdown -= n;
+        samp += n;
+    }
+
+    if (!adsr.isActive()) clearCurrentNote();
+}
\ No newline at end of file
@@ -0,0 +1,256 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include "FixedDelayBuffer.h"
+#include "GrainCloud.h"
+#include "ModMatrix.h"
+#include "SharedCaptureRing.h"
+#include "Envelope.h"
+#include "SpectralFreeze.h"
+
+// Host grid information for the current block, in samples
+struct FreezeSync
+{
+    bool enabled = false;
+    double samplesSinceGrid = 0;
+    double gridSamples = 0;
+    double regionSamples = 0;
+};
+
+// Capture rings and the frozen copy taken from them at note-on. The frozen table
+// is interleaved stereo frames, so one interpolation tap reads both channels from
+// the same cache line; a guard frame past the end repeats the first so the upper
+// tap never wraps.
+template <typename T>
+struct FreezeTables
+{
+    static constexpr int channels = SampleFormat::channelsPerFrame;
+
+    explicit FreezeTables(int size) { setSize(size, size); }
+
+    // Voices freezing from a shared ring keep no rolls of their own
+    void setSize(int size, int rollSize)
+    {
+        if (numFrames == size && leftRoll.getSize() == rollSize) return;
+        leftRoll.setSize(rollSize);
+        rightRoll.setSize(rollSize);
+        numFrames = size;
+        frames.assign((size_t)(size > 0 ? size + 1 : 0) * channels, T());
+    }
+
+    void updateGuardFrame() noexcept
+    {
+        if (numFrames > 0) std::copy(frames.begin(), frames.begin() + channels, frames.end() - channels);
+    }
+
+    FixedDelayBuffer<T> leftRoll{ 0 };
+    FixedDelayBuffer<T> rightRoll{ 0 };
+    std::vector<T> frames;
+    int numFrames = 0;
+};
+
+// One channel pair of rendered output, replayed while a note holds steady
+template <typename T>
+struct LoopCache
+{
+    explicit LoopCache(int size) { setSize(size); }
+
+    void setSize(int size)
+    {
+        left.assign((size_t)size, T());
+        right.assign((size_t)size, T());
+    }
+
+    std::vector<T> left;
+    std::vector<T> right;
+};
+
+// Driven by VoiceManager, which calls it directly rather than through juce::SynthesiserVoice.
+// Like the rest of Source/Core it has no JUCE dependency; buffers arrive as raw channel pointers.
+class SynthVoice final
+{
+public:
+    static float expDecay(float now, float targ, float rate, float sRate = 96000);
+    static float linDecay(float base, float now, float targ, float rate, float sRate = 96000);
+    static float linDecayBlock(float base, float now, float targ, float rate, float sRate, int numSamples);
+    void startNote(int midiNoteNumber, float velocity, int currentPitchWheelPosition);
+    void stopNote(float velocity, bool allowTailOff);
+    void controllerMoved(int controllerNumber, int newControllerValue);
+    void aftertouchChanged(int newAftertouchValue);
+    void channelPressureChanged(int newChannelPressureValue);
+    void pitchWheelMoved(int newPitchWheelValue);
+    void setCurrentPlaybackSampleRate(double newRate) { currentSampleRate = newRate; }
+    double getSampleRate() const noexcept { return currentSampleRate; }
+    int getCurrentlyPlayingNote() const noexcept { return currentNote; }
+    bool isVoiceActive() const noexcept { return currentNote >= 0; }
+    bool isKeyDown() const noexcept { return keyDown; }
+    void setKeyDown(bool isDown) noexcept { keyDown = isDown; }
+    void clearCurrentNote() noexcept { currentNote = -1; }
+    void prepareToPlay(double sampleRate, int samplesPerBlock, int outputChannels, bool useDoublePrecision = false);
+    void setStorage(bool useDoublePrecision, const SharedCaptureRing* source = nullptr);
+    void resetState();
+    void renderNextBlock(float* left, float* right, int startSample, int numSamples);
+    void renderNextBlock(double* left, double* right, int startSample, int numSamples);
+    void formantChanged(float newFormant);
+    void formantEnvelopeChanged(float depth, float newWidth, bool linear = false);
+    void adsrChanged(float a, float d, float s, float r, float curve);
+    void portamentoChanged(float p);
+    void wetDryChanged(float wet, float dry);
+    void blockStarted(int numSamples, const FreezeSync& newSync);
+    void modulationChanged(int slot, int source, int destination, float amount);
+    void lfoChanged(int index, float rate, int shape);
+    void modControllerChanged(int controllerNumber);
+    void granularChanged(bool enabled, int numGrains, float length, float jitter, float spread);
+    void legatoChanged(bool enabled, int controllerNumber);
+    void spectralChanged(bool enabled, int sizeIndex, int phaseMode);
+    // Freeze-time level correction, measured over the part of the table that is played
+    enum LevelMode { levelOff, levelRemoveDc, levelNormalize, numLevelModes };
+    static constexpr const char* levelNames[numLevelModes] = { "Off", "Remove DC", "Normalize" };
+    void levelChanged(int mode);
+    int copyLoop(float* frames, int maxFrames, double& loopStart, double& loopLength) const noexcept;
+    bool takingData = true;
+
+    // Writes the block's input into the capture rings of the matching precision
+    template <typename T>
+    void capture(const T* left, const T* right, int numSamples)
+    {
+        captureInto(getTables(T()), left, right, numSamples);
+    }
+
+    SynthVoice (int sr) {
+    }
+private:
+    template <typename S, typename T>
+    static void captureInto(FreezeTables<S>& tables, const T* left, const T* right, int numSamples)
+    {
+        if (isSilent(left, numSamples) && isSilent(right, numSamples)) {
+            tables.leftRoll.writeSilence(numSamples);
+            tables.rightRoll.writeSilence(numSamples);
+        }
+        else {
+            tables.leftRoll.writeBlock(left, numSamples);
+            tables.rightRoll.writeBlock(right, numSamples);
+        }
+    }
+
+    template <typename T>
+    static bool isSilent(const T* data, int numSamples) noexcept
+    {
+        for (int i = 0; i < numSamples; i++)
+            if (data[i] != 0) return false;
+        return true;
+    }
+
+    FreezeTables<float>& getTables(float) { return floatTables; }
+    FreezeTables<double>& getTables(double) { return doubleTables; }
+    void refreeze();
+    template <typename T> void freeze(FreezeTables<T>& tables);
+    template <typename T> int copyLoopFrom(const FreezeTables<T>& tables, float* dest, int maxFrames, double& loopStart, double& loopLength) const noexcept;
+    float clampCycle(double samples) const noexcept;
+    static double wrapLoop(double pos, double end, double cycle) noexcept;
+    template <typename T, typename S> static void readFrame(const FreezeTables<S>& tables, double pos, T& left, T& right) noexcept;
+    template <typename T> void renderBlock(T* outL, T* outR, int startSample, int numSamples);
+    template <typename T, typename S> void renderFrozen(const FreezeTables<S>& tables, T* wetL, T* wetR, int numSamples);
+
+    // Only the host's precision is allocated
+    FreezeTables<float> floatTables{ FixedDelayBuffer<float>::defaultSize };
+    FreezeTables<double> doubleTables{ 0 };
+    bool doublePrecision = false;
+    const SharedCaptureRing* captureSource = nullptr;
+
+    float formant = 1;
+    float formantBase = 1;
+    float formantTarget = 1;
+    float formantRate = 0.9999;
+    float formantRateLinear = 0.001;
+
+    float pWheel = 1;
+
+    bool frequencyInit = true;
+    float frequency = 440;
+    float frequencyTarget = 440;
+
+    float usePortamento = false;
+    float portamentoBase = 440;
+    float portamento = 0.01;
+    float portamentoAmount = 1;
+
+    float wet = 1;
+    float dry = 0;
+
+    float sampleRate = 96000;
+    double currentSampleRate = 44100;
+    int currentNote = -1;
+    bool keyDown = false;
+
+    double position = 0;
+    float tableStart = 0;           // the start of the synced region, otherwise 0
+    float tableEnd = 0;
+
+    FreezeSync sync;
+    int blockSize = 0;
+    int blockPosition = 0;
+
+    bool exp = true;
+
+    bool granular = false;
+    GrainCloud grains;
+
+    bool spectral = false;
+    SpectralFreeze spectrum;
+
+    static constexpr float normalizeTarget = 0.125f;   // -18 dBFS RMS
+    static constexpr float maxNormalizeGain = 16;
+    template <typename T> void measureLevel(const FreezeTables<T>& tables, float start);
+    template <typename T> void applyLevel(T* wetL, T* wetR, int numSamples, bool removeDc) const noexcept;
+    int levelMode = levelOff;
+    float levelGain = 1;
+    float dcLeft = 0;
+    float dcRight = 0;
+
+    // Once every glide has settled the looped output is periodic, so a whole number
+    // of cycles is rendered once, with the read step trimmed by a few parts per
+    // million (well under 0.1 cent) so they fill a whole number of samples, and
+    // then replayed until anything moves
+    static constexpr int loopCacheSize = 16384;
+    LoopCache<float> floatCache{ loopCacheSize };
+    LoopCache<double> doubleCache{ 0 };
+    LoopCache<float>& getLoopCache(float) { return floatCache; }
+    LoopCache<double>& getLoopCache(double) { return doubleCache; }
+    bool isSteady() const noexcept;
+    bool updateLoopCache() noexcept;
+    void leaveLoopCache() noexcept;
+    template <typename T, typename S> void renderLoopCache(const FreezeTables<S>& tables, LoopCache<T>& cache, T* wetL, T* wetR, int numSamples) noexcept;
+    int cacheLength = 0;            // 0 while not caching
+    int cacheFilled = 0;
+    int cacheIndex = 0;
+    double cacheStart = 0;          // table position of cache index 0
+    double cacheFillPosition = 0;
+    double cacheRate = 0;
+    float cacheReadRate = 0;        // the settled values the cache was rendered for
+    float cacheCycle = 0;
+
+    bool legato = false;
+    bool legatoHandoff = false;
+    int refreezeController = 0;
+    bool refreezeHeld = false;
+
+    void updateModulation();
+    template <typename T> void renderIdle(T* outL, T* outR, int numSamples);
+    void skipSamples(int numSamples);
+    ModMatrix mod;
+    int modController = 1;
+    int controlCountdown = 0;
+    float modFormant = 1;
+    float modFormantStep = 0;
+    float modTarget = 1;
+    float modTargetStep = 0;
+    float wetGain = 1;
+    float wetGainStep = 0;
+    float dryGain = 0;
+    float dryGainStep = 0;
+
+    float cycleLength = 96000 / 440;
+    Envelope adsr;
+    bool isPrepared{ false };
+};
\ No newline at end of file
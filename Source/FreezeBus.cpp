@@ -0,0 +1,30 @@
+#include "FreezeBus.h"
+
+FreezeBus::Channel& FreezeBus::getChannel(int channel)
+{
+    auto& c = channels[jlimit(0, numChannels - 1, channel)];
+    if (c.ring == nullptr) c.ring = std::make_unique<SharedCaptureRing>();
+    return c;
+}
+
+SharedCaptureRing* FreezeBus::claimSender(int channel, const void* owner)
+{
+    const ScopedLock sl(lock);
+    auto& c = getChannel(channel);
+    if (c.sender != nullptr && c.sender != owner) return nullptr;
+    c.sender = owner;
+    return c.ring.get();
+}
+
+void FreezeBus::releaseSender(int channel, const void* owner)
+{
+    const ScopedLock sl(lock);
+    auto& c = channels[jlimit(0, numChannels - 1, channel)];
+    if (c.sender == owner) c.sender = nullptr;
+}
+
+SharedCaptureRing* FreezeBus::getRing(int channel)
+{
+    const ScopedLock sl(lock);
+    return getChannel(channel).ring.get();
+}
@@ -0,0 +1,33 @@
+#pragma once
+#include <JuceHeader.h>
+#include "Core/SharedCaptureRing.h"
+
+// Process-wide registry of shared capture rings, reached through a
+// SharedResourcePointer so every Icebox instance in the host process sees the same
+// one. Each channel has at most one sender, which captures straight into the ring,
+// and any number of receivers, which freeze from it without keeping rolls of their
+// own. Rings are allocated the first time a channel is used and live as long as the
+// registry. Claiming and lookup are for the message thread; the audio threads only
+// touch the rings themselves.
+class FreezeBus
+{
+public:
+    static constexpr int numChannels = 4;
+
+    // Returns nullptr when another instance already sends on the channel
+    SharedCaptureRing* claimSender(int channel, const void* owner);
+    void releaseSender(int channel, const void* owner);
+    SharedCaptureRing* getRing(int channel);
+
+private:
+    struct Channel
+    {
+        std::unique_ptr<SharedCaptureRing> ring;
+        const void* sender = nullptr;
+    };
+
+    Channel& getChannel(int channel);
+
+    CriticalSection lock;
+    Channel channels[numChannels];
+};
@@ -0,0 +1,94 @@
+#include "LoopExporter.h"
+#include "Core/CycleResampler.h"
+
+LoopExporter::~LoopExporter()
+{
+    stopThread(2000);
+    delete requested.exchange(nullptr);
+    delete filled.exchange(nullptr);
+}
+
+bool LoopExporter::request(const File& file, int cycleSize)
+{
+    bool idle = false;
+    if (!busy.compare_exchange_strong(idle, true)) return false;
+
+    // Room for the whole table, so the audio thread can copy any loop without allocating
+    auto snapshot = std::make_unique<Snapshot>();
+    snapshot->file = file;
+    snapshot->cycleSize = cycleSize;
+    snapshot->frames.resize((size_t)(FixedDelayBuffer<float>::defaultSize + 1) * SampleFormat::channelsPerFrame);
+    requested.store(snapshot.release(), std::memory_order_release);
+
+    if (!isThreadRunning()) startThread();
+    return true;
+}
+
+bool LoopExporter::cancelRequest()
+{
+    // Whichever of this and serviceRequest takes the snapshot first owns it
+    std::unique_ptr<Snapshot> snapshot(requested.exchange(nullptr, std::memory_order_acq_rel));
+    if (snapshot == nullptr) return false;
+    busy = false;
+    return true;
+}
+
+void LoopExporter::run()
+{
+    uint32 waitingSince = 0;
+    while (!threadShouldExit()) {
+        std::unique_ptr<Snapshot> snapshot(filled.exchange(nullptr, std::memory_order_acquire));
+        if (snapshot != nullptr) {
+            auto error = write(*snapshot);
+            Logger::writeToLog(error.isEmpty() ? "Exported " + snapshot->file.getFullPathName() : "Export failed: " + error);
+            busy = false;
+            waitingSince = 0;
+        }
+
+        // The request is only ever looked at, never dereferenced, so this thread can't
+        // race the audio thread or a cancel for it
+        if (requested.load(std::memory_order_relaxed) == nullptr) waitingSince = 0;
+        else if (waitingSince == 0) waitingSince = jmax((uint32)1, Time::getMillisecondCounter());
+        else if (Time::getMillisecondCounter() - waitingSince > requestTimeoutMs) {
+            if (cancelRequest()) Logger::writeToLog("Export cancelled: no audio was processed to take the loop from");
+            waitingSince = 0;
+        }
+        wait(20);
+    }
+}
+
+String LoopExporter::write(const Snapshot& snapshot)
+{
+    if (snapshot.numFrames == 0) return "no note is sounding";
+
+    // Wavetables are mono; a loop keeps both channels and carries its loop points
+    bool loop = snapshot.cycleSize == loopSize;
+    int size = loop ? jmax(1, roundToInt(snapshot.loopLength)) : snapshot.cycleSize;
+    AudioBuffer<float> cycle(2, size);
+    CycleResampler::resample(snapshot.frames.data(), snapshot.numFrames, snapshot.loopStart, snapshot.loopLength,
+        cycle.getWritePointer(0), cycle.getWritePointer(1), size);
+
+    StringPairArray metadata;
+    if (loop) {
+        metadata.set("NumSampleLoops", "1");
+        metadata.set("Loop0Type", "0");
+        metadata.set("Loop0Start", "0");
+        metadata.set("Loop0End", String(size - 1));
+    }
+    else {
+        cycle.addFrom(0, 0, cycle, 1, 0, size);
+        cycle.applyGain(0, 0, size, 0.5f);
+        cycle.setSize(1, size, true);
+    }
+
+    snapshot.file.deleteFile();
+    std::unique_ptr<FileOutputStream> stream(snapshot.file.createOutputStream());
+    if (stream == nullptr) return "can't write " + snapshot.file.getFullPathName();
+    WavAudioFormat wav;
+    std::unique_ptr<AudioFormatWriter> writer(wav.createWriterFor(stream.get(), snapshot.sampleRate, loop ? 2 : 1, 32, metadata, 0));
+    if (writer == nullptr) return "can't create a WAV writer";
+    stream.release();
+
+    if (!writer->writeFromAudioSampleBuffer(cycle, 0, size)) return "write failed";
+    return {};
+}
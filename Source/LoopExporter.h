@@ -0,0 +1,62 @@
+#pragma once
+#include <JuceHeader.h>
+#include <atomic>
+#include <vector>
+#include "Core/SynthVoice.h"
+
+// Saves the cycle a voice is looping as a WAV, either resampled to a fixed-size
+// single-cycle wavetable or at its own length with loop points. The message thread
+// hands over an empty snapshot, the audio thread fills it from the frozen table at
+// its next block and publishes it, and a background thread resamples and writes
+// it. The audio thread never allocates, locks or touches the disk.
+class LoopExporter : private Thread
+{
+public:
+    static constexpr int loopSize = 0;
+
+    static StringArray getSizeNames() { return { "Loop", "256", "512", "1024", "2048", "4096" }; }
+    static int getCycleSize(int index) noexcept { return index <= 0 ? loopSize : 128 << index; }
+
+    LoopExporter() : Thread("Icebox Export") {}
+    ~LoopExporter() override;
+
+    // Message thread. False while an earlier export is still in flight
+    bool request(const File& file, int cycleSize);
+    bool isBusy() const noexcept { return busy.load(); }
+
+    // Not the audio thread. Withdraws a request no block has picked up yet, as when
+    // playback stops first; one the audio thread already took is still written.
+    // Requests left waiting for requestTimeoutMs are withdrawn this way too.
+    bool cancelRequest();
+    static constexpr uint32 requestTimeoutMs = 2000;
+
+    // Audio thread, once per block
+    void serviceRequest(const SynthVoice& voice) noexcept
+    {
+        auto* snapshot = requested.exchange(nullptr, std::memory_order_acquire);
+        if (snapshot == nullptr) return;
+        snapshot->sampleRate = voice.getSampleRate();
+        snapshot->numFrames = voice.copyLoop(snapshot->frames.data(), (int)snapshot->frames.size() / 2, snapshot->loopStart, snapshot->loopLength);
+        filled.store(snapshot, std::memory_order_release);
+    }
+
+private:
+    // Immutable once published
+    struct Snapshot
+    {
+        File file;
+        int cycleSize = loopSize;
+        double sampleRate = 44100;
+        std::vector<float> frames;
+        int numFrames = 0;
+        double loopStart = 0;
+        double loopLength = 0;
+    };
+
+    void run() override;
+    static String write(const Snapshot& snapshot);
+
+    std::atomic<Snapshot*> requested{ nullptr };
+    std::atomic<Snapshot*> filled{ nullptr };
+    std::atomic<bool> busy{ false };
+};
@@ -0,0 +1,63 @@
+#include "OutputRecorder.h"
+
+bool OutputRecorder::start(const File& file, double sampleRate, double fifoSeconds)
+{
+    if (isThreadRunning()) return true;
+    if (sampleRate <= 0) return false;
+
+    std::unique_ptr<AudioFormat> format;
+    if (file.hasFileExtension("flac")) format = std::make_unique<FlacAudioFormat>();
+    else format = std::make_unique<WavAudioFormat>();
+
+    file.deleteFile();
+    std::unique_ptr<FileOutputStream> stream(file.createOutputStream());
+    if (stream == nullptr) return false;
+    // FLAC tops out at 24 bits; WAV keeps the float output as it is
+    int bits = file.hasFileExtension("flac") ? 24 : 32;
+    writer.reset(format->createWriterFor(stream.get(), sampleRate, 2, bits, {}, 0));
+    if (writer == nullptr) return false;
+    stream.release();
+
+    // Recording is off and stop() saw the last block out, so the audio thread isn't
+    // touching the FIFO
+    int size = jmax(4096, roundToInt(fifoSeconds * sampleRate));
+    buffer.setSize(2, size, false, true, false);
+    fifo.setTotalSize(size);
+    fifo.reset();
+    overruns = 0;
+    writeFailed = false;
+    std::uint32_t session = (state.load(std::memory_order_relaxed) >> sessionShift) + 1;
+    state.store(session << sessionShift | recordingBit, std::memory_order_release);
+    startThread();
+    return true;
+}
+
+void OutputRecorder::stop()
+{
+    if (!isThreadRunning()) return;
+
+    // After this no push can claim the FIFO, so wait out one that already has
+    state.fetch_and(~recordingBit, std::memory_order_acq_rel);
+    while ((state.load(std::memory_order_acquire) & writingBit) != 0) Thread::yield();
+    stopThread(2000);
+    drain();
+    writer.reset();
+    Logger::writeToLog("Recording stopped, " + String(getNumOverruns()) + " overruns" + (writeFailed ? ", write failed" : ""));
+}
+
+void OutputRecorder::run()
+{
+    while (!threadShouldExit()) {
+        drain();
+        wait(20);
+    }
+}
+
+void OutputRecorder::drain()
+{
+    int start1, size1, start2, size2;
+    fifo.prepareToRead(fifo.getNumReady(), start1, size1, start2, size2);
+    if (size1 > 0 && !writer->writeFromAudioSampleBuffer(buffer, start1, size1)) writeFailed = true;
+    if (size2 > 0 && !writer->writeFromAudioSampleBuffer(buffer, start2, size2)) writeFailed = true;
+    fifo.finishedRead(size1 + size2);
+}
@@ -0,0 +1,70 @@
+#pragma once
+#include <JuceHeader.h>
+#include <atomic>
+#include <cstdint>
+#include "Core/SampleFormat.h"
+
+// Records the plugin's output to WAV or FLAC (chosen by the file's extension). The
+// audio thread copies each block into a FIFO and never waits; a background thread
+// drains it to the writer in large chunks. A block that doesn't fit because the
+// disk has fallen behind is dropped whole and counted as an overrun.
+class OutputRecorder : private Thread
+{
+public:
+    static constexpr double defaultFifoSeconds = 2;
+
+    static StringArray getFormatNames() { return { "WAV", "FLAC" }; }
+    static StringArray getFifoNames() { return { "0.5 s", "1 s", "2 s", "5 s" }; }
+    static double getFifoSeconds(int index) noexcept { return index == 0 ? 0.5 : index == 3 ? 5. : (double)index; }
+
+    OutputRecorder() : Thread("Icebox Recorder") {}
+    ~OutputRecorder() override { stop(); }
+
+    // Message thread only. The FIFO is sized when recording starts
+    bool start(const File& file, double sampleRate, double fifoSeconds = defaultFifoSeconds);
+    void stop();
+
+    bool isRecording() const noexcept { return (state.load(std::memory_order_acquire) & recordingBit) != 0; }
+    int getNumOverruns() const noexcept { return overruns.load(); }
+
+    // Audio thread. A block is written only after claiming the session it saw, in the
+    // same exchange that checks the session is still current, and stop() waits for the
+    // claim to be released, so the FIFO is never reset or resized under a block.
+    template <typename T>
+    void push(const T* left, const T* right, int numSamples) noexcept
+    {
+        std::uint32_t session = state.load(std::memory_order_acquire);
+        if ((session & recordingBit) == 0) return;
+        if (!state.compare_exchange_strong(session, session | writingBit, std::memory_order_acquire)) return;
+
+        if (fifo.getFreeSpace() < numSamples) overruns++;
+        else {
+            int start1, size1, start2, size2;
+            fifo.prepareToWrite(numSamples, start1, size1, start2, size2);
+            SampleFormat::write(buffer.getWritePointer(0, start1), left, size1);
+            SampleFormat::write(buffer.getWritePointer(1, start1), right, size1);
+            SampleFormat::write(buffer.getWritePointer(0, start2), left + size1, size2);
+            SampleFormat::write(buffer.getWritePointer(1, start2), right + size1, size2);
+            fifo.finishedWrite(size1 + size2);
+        }
+        state.fetch_and(~writingBit, std::memory_order_release);
+    }
+
+private:
+    void run() override;
+    void drain();
+
+    // The recording and writing flags share a word with a session number that start()
+    // advances, so a push that read the state of an earlier session can't claim this one
+    static constexpr std::uint32_t recordingBit = 1;
+    static constexpr std::uint32_t writingBit = 2;
+    static constexpr int sessionShift = 2;
+
+    AbstractFifo fifo{ 1 };
+    AudioBuffer<float> buffer;
+    std::atomic<std::uint32_t> state{ 0 };
+    std::atomic<int> overruns{ 0 };
+
+    std::unique_ptr<AudioFormatWriter> writer;
+    bool writeFailed = false;
+};
@@ -0,0 +1,49 @@
+#pragma once
+#include <JuceHeader.h>
+
+struct ParameterEvent
+{
+    int index = 0;
+    float value = 0;
+};
+
+// Fixed-size single-producer, single-consumer FIFO of parameter changes: the message
+// thread pushes and the audio thread pops, neither of them locking.
+class ParameterEventQueue
+{
+public:
+    static constexpr int capacity = 512;
+
+    bool push(const ParameterEvent& event) noexcept
+    {
+        if (fifo.getFreeSpace() == 0) {
+            overflowed = true;
+            return false;
+        }
+        int start1, size1, start2, size2;
+        fifo.prepareToWrite(1, start1, size1, start2, size2);
+        events[(size_t)(size1 > 0 ? start1 : start2)] = event;
+        fifo.finishedWrite(1);
+        return true;
+    }
+
+    bool pop(ParameterEvent& event) noexcept
+    {
+        int start1, size1, start2, size2;
+        fifo.prepareToRead(1, start1, size1, start2, size2);
+        if (size1 + size2 == 0) return false;
+        event = events[(size_t)(size1 > 0 ? start1 : start2)];
+        fifo.finishedRead(1);
+        return true;
+    }
+
+    bool isEmpty() const noexcept { return fifo.getNumReady() == 0; }
+
+    // True once if any event was dropped since the last call
+    bool checkAndClearOverflow() noexcept { return overflowed.exchange(false); }
+
+private:
+    AbstractFifo fifo{ capacity };
+    std::array<ParameterEvent, capacity> events;
+    std::atomic<bool> overflowed{ false };
+};
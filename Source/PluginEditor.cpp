@@ -39,6 +39,48 @@ IceboxAudioProcessorEditor::IceboxAudioProcessorEditor (IceboxAudioProcessor& p)
     linearToggle.setColour(ToggleButton::ColourIds::tickDisabledColourId, Colours::black);
     linearToggle.addListener(this);
 
+    traceToggle.setButtonText("Trace");
+    traceToggle.setToggleState(audioProcessor.trace.isRecording(), false);
+    traceToggle.setColour(ToggleButton::ColourIds::textColourId, Colours::black);
+    traceToggle.setColour(ToggleButton::ColourIds::tickColourId, Colours::black);
+    traceToggle.setColour(ToggleButton::ColourIds::tickDisabledColourId, Colours::black);
+    traceToggle.addListener(this);
+
+    recordToggle.setButtonText("Record");
+    recordToggle.setToggleState(audioProcessor.recorder.isRecording(), false);
+    recordToggle.setColour(ToggleButton::ColourIds::textColourId, Colours::black);
+    recordToggle.setColour(ToggleButton::ColourIds::tickColourId, Colours::black);
+    recordToggle.setColour(ToggleButton::ColourIds::tickDisabledColourId, Colours::black);
+    recordToggle.addListener(this);
+
+    recordFormatBox.addItemList(OutputRecorder::getFormatNames(), 1);
+    recordFormatBox.setSelectedItemIndex(0, dontSendNotification);
+    recordFifoBox.addItemList(OutputRecorder::getFifoNames(), 1);
+    recordFifoBox.setSelectedItemIndex(2, dontSendNotification);
+
+    freezeBusBox.addItemList(IceboxAudioProcessor::getFreezeBusNames(), 1);
+    freezeBusBox.setSelectedItemIndex(audioProcessor.getFreezeBus(), dontSendNotification);
+    freezeBusBox.onChange = [this] {
+        // Only one instance may send on a channel
+        if (!audioProcessor.setFreezeBus(freezeBusBox.getSelectedItemIndex()))
+            freezeBusBox.setSelectedItemIndex(audioProcessor.getFreezeBus(), dontSendNotification);
+    };
+
+    exportSizeBox.addItemList(LoopExporter::getSizeNames(), 1);
+    exportSizeBox.setSelectedItemIndex(4, dontSendNotification);
+
+    exportButton.setButtonText("Export");
+    exportButton.onClick = [this] {
+        exportChooser = std::make_unique<FileChooser>("Export the frozen loop", File::getSpecialLocation(File::userDocumentsDirectory), "*.wav");
+        exportChooser->launchAsync(FileBrowserComponent::saveMode | FileBrowserComponent::canSelectFiles | FileBrowserComponent::warnAboutOverwriting,
+            [this](const FileChooser& chooser) {
+                auto file = chooser.getResult();
+                if (file == File()) return;
+                if (!audioProcessor.exporter.request(file.withFileExtension(".wav"), LoopExporter::getCycleSize(exportSizeBox.getSelectedItemIndex())))
+                    Logger::writeToLog("Export skipped: the previous export is still being written");
+            });
+    };
+
     aSlider.setSliderStyle(Slider::LinearVertical);
     aSlider.setRange(0, 1, 0.01);
     aSlider.setTextBoxStyle(Slider::NoTextBox, false, 90, 0);
@@ -106,6 +148,8 @@ IceboxAudioProcessorEditor::IceboxAudioProcessorEditor (IceboxAudioProcessor& p)
     portamentoSlider.setComponentID("8");
     wetSlider.setComponentID("9");
     drySlider.setComponentID("10");
+    traceToggle.setComponentID("12");
+    recordToggle.setComponentID("13");
 
     addAndMakeVisible(formantSlider);
     addAndMakeVisible(formantDecaySlider);
@@ -118,6 +162,13 @@ IceboxAudioProcessorEditor::IceboxAudioProcessorEditor (IceboxAudioProcessor& p)
     addAndMakeVisible(portamentoSlider);
     addAndMakeVisible(wetSlider);
     addAndMakeVisible(drySlider);
+    addAndMakeVisible(traceToggle);
+    addAndMakeVisible(recordToggle);
+    addAndMakeVisible(recordFormatBox);
+    addAndMakeVisible(recordFifoBox);
+    addAndMakeVisible(freezeBusBox);
+    addAndMakeVisible(exportButton);
+    addAndMakeVisible(exportSizeBox);
 
     audioProcessor.broadcaster.addChangeListener(this);
 }
@@ -180,6 +231,23 @@ void IceboxAudioProcessorEditor::somethingChanged(int compID)
     case 10:
         (*audioProcessor.dry).setValueNotifyingHost((*audioProcessor.dry).convertTo0to1(drySlider.getValue()));
         break;
+    case 12:
+        if (!traceToggle.getToggleState()) audioProcessor.trace.stop();
+        else if (!audioProcessor.trace.isRecording()) {
+            auto file = File::getSpecialLocation(File::userDocumentsDirectory).getNonexistentChildFile("Icebox Trace", ".json");
+            if (!audioProcessor.trace.start(file)) traceToggle.setToggleState(false, dontSendNotification);
+        }
+        break;
+    case 13:
+        if (!recordToggle.getToggleState()) audioProcessor.recorder.stop();
+        else if (!audioProcessor.recorder.isRecording()) {
+            auto extension = recordFormatBox.getSelectedItemIndex() == 1 ? ".flac" : ".wav";
+            auto file = File::getSpecialLocation(File::userMusicDirectory).getNonexistentChildFile("Icebox Recording", extension);
+            double fifoSeconds = OutputRecorder::getFifoSeconds(recordFifoBox.getSelectedItemIndex());
+            if (!audioProcessor.recorder.start(file, audioProcessor.getSampleRate(), fifoSeconds))
+                recordToggle.setToggleState(false, dontSendNotification);
+        }
+        break;
     }
 }
 
@@ -198,7 +266,15 @@ void IceboxAudioProcessorEditor::paint (Graphics& g)
 
     g.setColour (Colours::black);
     g.setFont (30.0f);
-    g.drawFittedText ("Icebox", box.removeFromTop(50).removeFromTop(30), Justification::centred, 1);
+    auto titleRow = box.removeFromTop(50);
+    traceToggle.setBounds(titleRow.getRight() - 200, titleRow.getY(), 70, 25);
+    recordToggle.setBounds(titleRow.getRight() - 200, titleRow.getY() + 27, 75, 22);
+    recordFormatBox.setBounds(titleRow.getRight() - 120, titleRow.getY() + 27, 60, 22);
+    recordFifoBox.setBounds(titleRow.getRight() - 55, titleRow.getY() + 27, 55, 22);
+    freezeBusBox.setBounds(titleRow.getX(), titleRow.getY(), 110, 25);
+    exportButton.setBounds(titleRow.getX(), titleRow.getY() + 27, 50, 22);
+    exportSizeBox.setBounds(titleRow.getX() + 55, titleRow.getY() + 27, 55, 22);
+    g.drawFittedText ("Icebox", titleRow.removeFromTop(30), Justification::centred, 1);
     auto left = box.removeFromLeft(320);
 
     auto lu = left.removeFromLeft(120);
@@ -294,6 +370,10 @@ void IceboxAudioProcessorEditor::reload() {
 void IceboxAudioProcessorEditor::changeListenerCallback(juce::ChangeBroadcaster* source)
 {
     if (source == &audioProcessor.broadcaster) {
+        QualityGovernor::Decision decision;
+        while (audioProcessor.governor.popDecision(decision))
+            Logger::writeToLog("Icebox quality " + String(decision.from) + " -> " + String(decision.to)
+                               + " at load " + String(decision.load, 2) + " (" + Time(decision.time).toString(false, true) + ")");
         reload();
         resized();
         repaint();
@@ -39,6 +39,14 @@ private:
     Slider drySlider;
 
     ToggleButton linearToggle;
+    ToggleButton traceToggle;
+    ToggleButton recordToggle;
+    ComboBox recordFormatBox;
+    ComboBox recordFifoBox;
+    ComboBox freezeBusBox;
+    TextButton exportButton;
+    ComboBox exportSizeBox;
+    std::unique_ptr<FileChooser> exportChooser;
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (IceboxAudioProcessorEditor)
 };
@@ -10,8 +10,8 @@ IceboxAudioProcessor::IceboxAudioProcessor()
                        )
 #endif
 {
-    synth.addSound(new SynthSound());
-    synth.addVoice(new SynthVoice(96000));
+    synth.addVoice(std::make_unique<SynthVoice>(96000));
+    synth.setTraceRecorder(&trace);
     addParameter(formant = new AudioParameterFloat("formant", "Formant", -24, 24, 0));
     addParameter(formantDecay = new AudioParameterFloat("formantDecay", "Decay", -24, 24, 0));
     addParameter(formantDecayRate = new AudioParameterFloat("formantDecayRate", "Rate", 0.01, 2, 0.01));
@@ -26,10 +26,59 @@ IceboxAudioProcessor::IceboxAudioProcessor()
 
     addParameter(wet = new AudioParameterFloat("wet", "Wet", 0, 100, 100));
     addParameter(dry = new AudioParameterFloat("dry", "Dry", 0, 100, 0));
+
+    addParameter(granular = new AudioParameterBool("granular", "Granular", false));
+    addParameter(grainCount = new AudioParameterInt("grainCount", "Grains", 1, GrainCloud::maxGrains, 8));
+    addParameter(grainLength = new AudioParameterFloat("grainLength", "Grain Length", 0.01, 0.5, 0.1));
+    addParameter(grainJitter = new AudioParameterFloat("grainJitter", "Grain Jitter", 0, 100, 25));
+    addParameter(grainSpread = new AudioParameterFloat("grainSpread", "Grain Spread", 0, 12, 0));
+
+    addParameter(freezeSync = new AudioParameterBool("freezeSync", "Sync Freeze", false));
+    addParameter(freezeGrid = new AudioParameterChoice("freezeGrid", "Freeze Grid", { "1/1", "1/2", "1/4", "1/8", "1/16", "1/32" }, 4));
+    addParameter(freezeLength = new AudioParameterChoice("freezeLength", "Freeze Length", { "Full", "1/1", "1/2", "1/4", "1/8", "1/16", "1/32" }, 0));
+
+    for (int i = 0; i < ModMatrix::numLfos; i++) {
+        String n(i + 1);
+        addParameter(lfoRate[i] = new AudioParameterFloat("lfo" + n + "Rate", "LFO " + n + " Rate", 0.01, 20, 1));
+        addParameter(lfoShape[i] = new AudioParameterChoice("lfo" + n + "Shape", "LFO " + n + " Shape", StringArray(ModMatrix::shapeNames, ModMatrix::numShapes), 0));
+    }
+    addParameter(modController = new AudioParameterInt("modController", "Mod CC", 0, 127, 1));
+    for (int i = 0; i < ModMatrix::numSlots; i++) {
+        String n(i + 1);
+        addParameter(modSource[i] = new AudioParameterChoice("mod" + n + "Source", "Mod " + n + " Source", StringArray(ModMatrix::sourceNames, ModMatrix::numSources), 0));
+        addParameter(modDestination[i] = new AudioParameterChoice("mod" + n + "Destination", "Mod " + n + " Destination", StringArray(ModMatrix::destinationNames, ModMatrix::numDestinations), 0));
+        addParameter(modAmount[i] = new AudioParameterFloat("mod" + n + "Amount", "Mod " + n + " Amount", -100, 100, 0));
+    }
+
+    addParameter(envelopeCurve = new AudioParameterFloat("envelopeCurve", "Envelope Curve", 0, 100, 0));
+
+    addParameter(legato = new AudioParameterBool("legato", "Legato", false));
+    addParameter(refreezeController = new AudioParameterInt("refreezeController", "Refreeze CC", 0, 127, 0));
+
+    addParameter(autoFreeze = new AudioParameterBool("autoFreeze", "Auto Freeze", false));
+    addParameter(autoFreezeSensitivity = new AudioParameterFloat("autoFreezeSensitivity", "Auto Freeze Sensitivity", 0, 100, 50));
+    addParameter(autoFreezeLength = new AudioParameterFloat("autoFreezeLength", "Auto Freeze Length", 0.005, 0.5, 0.05));
+    addParameter(autoFreezeNote = new AudioParameterInt("autoFreezeNote", "Auto Freeze Note", 0, 127, 60));
+
+    addParameter(spectral = new AudioParameterBool("spectral", "Spectral Freeze", false));
+    addParameter(spectralSize = new AudioParameterChoice("spectralSize", "Spectral Size", StringArray(SpectralFreeze::sizeNames, SpectralFreeze::numSizes), 1));
+    addParameter(spectralPhase = new AudioParameterChoice("spectralPhase", "Spectral Phase", StringArray(SpectralFreeze::phaseNames, SpectralFreeze::numPhaseModes), 0));
+
+    addParameter(notePriority = new AudioParameterChoice("notePriority", "Note Priority", VoiceManager::getPriorityNames(), 0));
+    addParameter(qualityGovernor = new AudioParameterBool("qualityGovernor", "Quality Governor", false));
+    addParameter(freezeLevel = new AudioParameterChoice("freezeLevel", "Freeze Level", StringArray(SynthVoice::levelNames, SynthVoice::numLevelModes), 0));
+
+    paramValues.resize((size_t)getParameters().size());
+    syncParameterValues();
+    for (auto* parameter : getParameters())
+        parameter->addListener(this);
 }
 
 IceboxAudioProcessor::~IceboxAudioProcessor()
 {
+    if (busSending) freezeBus->releaseSender(freezeBusSetting - 1, this);
+    for (auto* parameter : getParameters())
+        parameter->removeListener(this);
 }
 
 //==============================================================================
@@ -101,19 +150,74 @@ void IceboxAudioProcessor::prepareToPlay (double sampleRate, int samplesPerBlock
 
     for (int i = 0; i < synth.getNumVoices(); i++)
     {
-        if (auto voice = dynamic_cast<SynthVoice*>(synth.getVoice(i)))
-        {
-            voice->prepareToPlay(sampleRate, samplesPerBlock, getTotalNumOutputChannels());
-            voice->formantChanged((*formant).get());
-            voice->formantEnvelopeChanged((*formantDecay).get(), (*formantDecayRate).get(), true);
-        }
+        auto voice = synth.getVoice(i);
+        voice->prepareToPlay(sampleRate, samplesPerBlock, getTotalNumOutputChannels(), isUsingDoublePrecision());
+        voice->formantChanged((*formant).get());
+        voice->formantEnvelopeChanged((*formantDecay).get(), (*formantDecayRate).get(), true);
+        voice->resetState();
     }
+
+    onsets.prepare(sampleRate);
+    lastAutoFreezeLength = -1;
+    autoFreezeCountdown = -1;
+    autoFreezeHeld = -1;
+    autoFreezeMidi.ensureSize(2048);
+    governor.prepare(sampleRate);
 }
 
 void IceboxAudioProcessor::releaseResources()
 {
-    // When playback stops, you can use this as an opportunity to free up any
-    // spare memory, etc.
+    // No block will come to fill a pending export
+    if (exporter.cancelRequest()) Logger::writeToLog("Export cancelled: playback stopped");
+}
+
+bool IceboxAudioProcessor::setFreezeBus(int setting)
+{
+    setting = jlimit(0, 2 * FreezeBus::numChannels, setting);
+    if (setting == freezeBusSetting) return true;
+
+    int channel = (setting - 1) % FreezeBus::numChannels;
+    bool send = setting > 0 && setting <= FreezeBus::numChannels;
+    SharedCaptureRing* ring = nullptr;
+    if (send) {
+        ring = freezeBus->claimSender(channel, this);
+        if (ring == nullptr) return false;
+    }
+    else if (setting > 0) ring = freezeBus->getRing(channel);
+
+    suspendProcessing(true);
+    if (busSending) freezeBus->releaseSender(freezeBusSetting - 1, this);
+    freezeBusSetting = setting;
+    busRing = ring;
+    busSending = send;
+    updateStorage();
+    suspendProcessing(false);
+    return true;
+}
+
+StringArray IceboxAudioProcessor::getFreezeBusNames()
+{
+    StringArray names{ "No Bus" };
+    for (int i = 1; i <= FreezeBus::numChannels; i++) names.add("Send " + String(i));
+    for (int i = 1; i <= FreezeBus::numChannels; i++) names.add("Receive " + String(i));
+    return names;
+}
+
+// Reallocates every voice's capture storage; the callback must be held off
+void IceboxAudioProcessor::updateStorage()
+{
+    for (int i = 0; i < synth.getNumVoices(); i++)
+        synth.getVoice(i)->setStorage(isUsingDoublePrecision(), busRing);
+}
+
+void IceboxAudioProcessor::reset()
+{
+    synth.allNotesOff(false);
+    for (int i = 0; i < synth.getNumVoices(); i++)
+        synth.getVoice(i)->resetState();
+    onsets.reset();
+    autoFreezeCountdown = -1;
+    autoFreezeHeld = -1;
 }
 
 #ifndef JucePlugin_PreferredChannelConfigurations
@@ -140,46 +244,184 @@ bool IceboxAudioProcessor::isBusesLayoutSupported (const BusesLayout& layouts) c
 #endif
 
 void IceboxAudioProcessor::processBlock (AudioBuffer<float>& buffer, MidiBuffer& midiMessages)
+{
+    process(buffer, midiMessages);
+}
+
+void IceboxAudioProcessor::processBlock (AudioBuffer<double>& buffer, MidiBuffer& midiMessages)
+{
+    process(buffer, midiMessages);
+}
+
+template <typename FloatType>
+void IceboxAudioProcessor::process(AudioBuffer<FloatType>& buffer, MidiBuffer& midiMessages)
 {
     ScopedNoDenormals noDenormals;
+    TraceRecorder::Scope scope(trace, "processBlock");
 
-    for (int j = 0; j < buffer.getNumSamples(); j++) {
-        if (SynthVoice* voice = dynamic_cast<SynthVoice*>(synth.getVoice(0))) {
-            checkParams(voice);
-            voice->leftRoll.writeSample(buffer.getSample(0, j));
-            voice->rightRoll.writeSample(buffer.getSample(1, j));
-        }
+    int numSamples = buffer.getNumSamples();
+    int64 blockStart = Time::getHighResolutionTicks();
+    audioThread = Thread::getCurrentThreadId();
+
+    SynthVoice* voice = synth.getVoice(0);
+
+    applyParameterEvents();
+    if (paramsDirty.exchange(false)) {
+        syncParameterValues();
+        checkParams(voice);
+    }
+    else if (paramsChanged) checkParams(voice);
+    paramsChanged = false;
+
+    {
+        TraceRecorder::Scope captureScope(trace, "capture");
+        // Bus receivers capture nothing; they freeze from the sender's ring
+        if (busSending) busRing->write(buffer.getReadPointer(0), buffer.getReadPointer(1), numSamples);
+        else if (busRing == nullptr) voice->capture(buffer.getReadPointer(0), buffer.getReadPointer(1), numSamples);
     }
+    voice->blockStarted(numSamples, getFreezeSync());
+    exporter.serviceRequest(*voice);
+    const MidiBuffer& midi = addAutoFreezeEvents(buffer, midiMessages) ? autoFreezeMidi : midiMessages;
 
-    float b0 = buffer.getSample(0, 0);
-    float b1 = buffer.getSample(1, 0);
+    synth.renderNextBlock(buffer, midi, 0, numSamples);
 
-    synth.renderNextBlock(buffer, midiMessages, 0, buffer.getNumSamples());
+    recorder.push(buffer.getReadPointer(0), buffer.getReadPointer(1), numSamples);
+
+    // Offline renders never degrade, so they stay deterministic
+    if (!isNonRealtime() && governor.blockFinished(numSamples, Time::getHighResolutionTicks() - blockStart))
+        paramsDirty = true;
+}
+
+// Watches the input for onsets and, once the chosen length of material after one has
+// been captured, re-strikes the auto-freeze note at that exact sample. Returns true
+// when the block's MIDI was merged into autoFreezeMidi.
+template <typename FloatType>
+bool IceboxAudioProcessor::addAutoFreezeEvents(const AudioBuffer<FloatType>& buffer, const MidiBuffer& midiMessages)
+{
+    int numSamples = buffer.getNumSamples();
+    if (lastAutoFreeze) {
+        int onset = onsets.process(buffer.getReadPointer(0), buffer.getReadPointer(1), numSamples);
+        if (onset >= 0 && autoFreezeCountdown < 0) autoFreezeCountdown = onset + autoFreezeSamples;
+    }
+    else autoFreezeCountdown = -1;
+
+    bool trigger = autoFreezeCountdown >= 0 && autoFreezeCountdown < numSamples;
+    bool release = !lastAutoFreeze && autoFreezeHeld >= 0;
+    int offset = trigger ? autoFreezeCountdown : 0;
+    if (autoFreezeCountdown >= 0) autoFreezeCountdown = trigger ? -1 : autoFreezeCountdown - numSamples;
+    if (!trigger && !release) return false;
+
+    autoFreezeMidi.clear();
+    autoFreezeMidi.addEvents(midiMessages, 0, numSamples, 0);
+    if (autoFreezeHeld >= 0) autoFreezeMidi.addEvent(MidiMessage::noteOff(1, autoFreezeHeld), offset);
+    autoFreezeHeld = -1;
+    if (trigger) {
+        autoFreezeHeld = lastAutoFreezeNote;
+        autoFreezeMidi.addEvent(MidiMessage::noteOn(1, autoFreezeHeld, 1.f), offset);
+    }
+    return true;
+}
+
+// Every change applies at the start of a block; JUCE passes no in-block timing for
+// automation. Changes made on the audio thread are written straight into paramValues
+// and applied at the start of the next block. The message thread has the event queue
+// to itself. Any other thread only marks the values dirty, and the next block re-reads
+// them all.
+void IceboxAudioProcessor::parameterValueChanged(int parameterIndex, float newValue)
+{
+    auto* parameter = dynamic_cast<RangedAudioParameter*>(getParameters()[parameterIndex]);
+    if (parameter == nullptr) return;
+
+    if (Thread::getCurrentThreadId() == audioThread.load()) {
+        paramValues[(size_t)parameterIndex] = parameter->convertFrom0to1(newValue);
+        paramsChanged = true;
+    }
+    else if (MessageManager::existsAndIsCurrentThread()) {
+        ParameterEvent event;
+        event.index = parameterIndex;
+        event.value = parameter->convertFrom0to1(newValue);
+        parameterEvents.push(event);
+    }
+    else paramsDirty = true;
+}
+
+void IceboxAudioProcessor::applyParameterEvents()
+{
+    if (parameterEvents.checkAndClearOverflow()) paramsDirty = true;
+
+    ParameterEvent event;
+    while (parameterEvents.pop(event)) {
+        paramValues[(size_t)event.index] = event.value;
+        paramsChanged = true;
+    }
+}
+
+void IceboxAudioProcessor::syncParameterValues()
+{
+    auto& parameters = getParameters();
+    for (int i = 0; i < parameters.size(); i++) {
+        if (auto* parameter = dynamic_cast<RangedAudioParameter*>(parameters[i]))
+            paramValues[(size_t)i] = parameter->convertFrom0to1(parameter->getValue());
+    }
+}
+
+double IceboxAudioProcessor::noteValueInQuarters(int index) {
+    // 0 = whole note, each step halves
+    return 4. / (1 << index);
+}
+
+FreezeSync IceboxAudioProcessor::getFreezeSync() {
+    FreezeSync sync;
+    auto* playHead = getPlayHead();
+    if (playHead == nullptr) return sync;
+
+    auto position = playHead->getPosition();
+    if (!position) return sync;
+
+    auto bpm = position->getBpm();
+    auto ppq = position->getPpqPosition();
+    if (!bpm || !ppq || *bpm <= 0) return sync;
+
+    double samplesPerQuarter = getSampleRate() * 60 / *bpm;
+
+    if ((*freezeSync).get()) {
+        double grid = noteValueInQuarters((*freezeGrid).getIndex());
+        double sinceGrid = std::fmod(*ppq, grid);
+        if (sinceGrid < 0) sinceGrid += grid;
+        sync.enabled = true;
+        sync.gridSamples = grid * samplesPerQuarter;
+        sync.samplesSinceGrid = sinceGrid * samplesPerQuarter;
+    }
+    if ((*freezeLength).getIndex() > 0)
+        sync.regionSamples = noteValueInQuarters((*freezeLength).getIndex() - 1) * samplesPerQuarter;
+
+    return sync;
 }
 
 void IceboxAudioProcessor::checkParams(SynthVoice* voice) {
+    TraceRecorder::Scope scope(trace, "checkParams");
     bool anythingChanged = false;
 
     // formant
-    if ((*formant).get() != lastFormant) {
-        lastFormant = (*formant).get();
+    if (value(formant) != lastFormant) {
+        lastFormant = value(formant);
         updateMe[0] = true;
         voice->formantChanged(lastFormant);
         anythingChanged = true;
     }
 
     // formant envelope
-    if ((*formantDecay).get() != lastFormantDecay || (*formantDecayRate).get() != lastFormantDecayRate || ((*formantDecayLinear).get() != lastLinear)) {
-        if (lastFormantDecay != (*formantDecay).get()) {
-            lastFormantDecay = (*formantDecay).get();
+    if (value(formantDecay) != lastFormantDecay || value(formantDecayRate) != lastFormantDecayRate || ((value(formantDecayLinear) > 0.5f) != lastLinear)) {
+        if (lastFormantDecay != value(formantDecay)) {
+            lastFormantDecay = value(formantDecay);
             updateMe[1] = true;
         }
-        if (lastFormantDecayRate != (*formantDecayRate).get()) {
-            lastFormantDecayRate = (*formantDecayRate).get();
+        if (lastFormantDecayRate != value(formantDecayRate)) {
+            lastFormantDecayRate = value(formantDecayRate);
             updateMe[2] = true;
         }
-        if (lastLinear != (*formantDecayLinear).get()) {
-            lastLinear = (*formantDecayLinear).get();
+        if (lastLinear != (value(formantDecayLinear) > 0.5f)) {
+            lastLinear = (value(formantDecayLinear) > 0.5f);
             updateMe[3] = true;
         }
         voice->formantEnvelopeChanged(lastFormantDecay, lastFormantDecayRate, lastLinear);
@@ -187,51 +429,128 @@ void IceboxAudioProcessor::checkParams(SynthVoice* voice) {
     }
 
     // adsr
-    if ((*attack).get() != lastAttack || (*decay).get() != lastDecay || (*sustain).get() != lastSustain || (*release).get() != lastRelease) {
-        if (lastAttack != (*attack).get()) {
-            lastAttack = (*attack).get();
+    if (value(attack) != lastAttack || value(decay) != lastDecay || value(sustain) != lastSustain || value(release) != lastRelease || value(envelopeCurve) != lastEnvelopeCurve) {
+        if (lastAttack != value(attack)) {
+            lastAttack = value(attack);
             updateMe[4] = true;
         }
-        if (lastDecay != (*decay).get()) {
-            lastDecay = (*decay).get();
+        if (lastDecay != value(decay)) {
+            lastDecay = value(decay);
             updateMe[5] = true;
         }
-        if (lastSustain != (*sustain).get()) {
-            lastSustain = (*sustain).get();
+        if (lastSustain != value(sustain)) {
+            lastSustain = value(sustain);
             updateMe[6] = true;
         }
-        if (lastRelease != (*release).get()) {
-            lastRelease = (*release).get();
+        if (lastRelease != value(release)) {
+            lastRelease = value(release);
             updateMe[7] = true;
         }
-        voice->adsrChanged(lastAttack, lastDecay, lastSustain / 100, lastRelease);
+        lastEnvelopeCurve = value(envelopeCurve);
+        voice->adsrChanged(lastAttack, lastDecay, lastSustain / 100, lastRelease, lastEnvelopeCurve / 100);
         anythingChanged = true;
     }
 
     // portamento
-    if ((*portamento).get() != lastPortamento) {
-        lastPortamento = (*portamento).get();
+    if (value(portamento) != lastPortamento) {
+        lastPortamento = value(portamento);
         updateMe[8] = true;
         voice->portamentoChanged(lastPortamento / 100);
         anythingChanged = true;
     }
 
     // wet
-    if (lastWet != (*wet).get()) {
-        lastWet = (*wet).get();
+    if (lastWet != value(wet)) {
+        lastWet = value(wet);
         updateMe[9] = true;
         voice->wetDryChanged(lastWet / 100., lastDry / 100.);
         anythingChanged = true;
     }
     
     // dry
-    if (lastDry != (*dry).get()) {
-        lastDry = (*dry).get();
+    if (lastDry != value(dry)) {
+        lastDry = value(dry);
         updateMe[10] = true;
         voice->wetDryChanged(lastWet / 100., lastDry / 100.);
         anythingChanged = true;
     }
 
+    // quality governor
+    lastQualityGovernor = (value(qualityGovernor) > 0.5f);
+    governor.setEnabled(lastQualityGovernor && !isNonRealtime());
+    bool qualityChanged = governor.getLevel() != lastQualityLevel;
+    lastQualityLevel = governor.getLevel();
+
+    // granular
+    if (qualityChanged || (value(granular) > 0.5f) != lastGranular || roundToInt(value(grainCount)) != lastGrainCount || value(grainLength) != lastGrainLength || value(grainJitter) != lastGrainJitter || value(grainSpread) != lastGrainSpread) {
+        lastGranular = (value(granular) > 0.5f);
+        lastGrainCount = roundToInt(value(grainCount));
+        lastGrainLength = value(grainLength);
+        lastGrainJitter = value(grainJitter);
+        lastGrainSpread = value(grainSpread);
+        int grains = jmin(lastGrainCount, QualityGovernor::getGrainLimit(lastQualityLevel));
+        voice->granularChanged(lastGranular, grains, lastGrainLength, lastGrainJitter / 100, lastGrainSpread);
+        anythingChanged = true;
+    }
+
+    // modulation
+    for (int i = 0; i < ModMatrix::numLfos; i++) {
+        if (modDirty || value(lfoRate[i]) != lastLfoRate[i] || roundToInt(value(lfoShape[i])) != lastLfoShape[i]) {
+            lastLfoRate[i] = value(lfoRate[i]);
+            lastLfoShape[i] = roundToInt(value(lfoShape[i]));
+            voice->lfoChanged(i, lastLfoRate[i], lastLfoShape[i]);
+        }
+    }
+    if (roundToInt(value(modController)) != lastModController) {
+        lastModController = roundToInt(value(modController));
+        voice->modControllerChanged(lastModController);
+    }
+    for (int i = 0; i < ModMatrix::numSlots; i++) {
+        if (modDirty || roundToInt(value(modSource[i])) != lastModSource[i] || roundToInt(value(modDestination[i])) != lastModDestination[i] || value(modAmount[i]) != lastModAmount[i]) {
+            lastModSource[i] = roundToInt(value(modSource[i]));
+            lastModDestination[i] = roundToInt(value(modDestination[i]));
+            lastModAmount[i] = value(modAmount[i]);
+            voice->modulationChanged(i, lastModSource[i], lastModDestination[i], lastModAmount[i] / 100);
+        }
+    }
+    modDirty = false;
+
+    // spectral
+    if (qualityChanged || (value(spectral) > 0.5f) != lastSpectral || roundToInt(value(spectralSize)) != lastSpectralSize || roundToInt(value(spectralPhase)) != lastSpectralPhase) {
+        lastSpectral = (value(spectral) > 0.5f);
+        lastSpectralSize = roundToInt(value(spectralSize));
+        lastSpectralPhase = roundToInt(value(spectralPhase));
+        int size = jmin(lastSpectralSize, QualityGovernor::getSpectralSizeLimit(lastQualityLevel));
+        voice->spectralChanged(lastSpectral, size, lastSpectralPhase);
+    }
+
+    // freeze level
+    if (roundToInt(value(freezeLevel)) != lastFreezeLevel) {
+        lastFreezeLevel = roundToInt(value(freezeLevel));
+        voice->levelChanged(lastFreezeLevel);
+    }
+
+    // voices
+    synth.setNotePriority(roundToInt(value(notePriority)));
+
+    // auto-freeze
+    lastAutoFreeze = (value(autoFreeze) > 0.5f);
+    lastAutoFreezeNote = roundToInt(value(autoFreezeNote));
+    if (value(autoFreezeSensitivity) != lastAutoFreezeSensitivity || value(autoFreezeLength) != lastAutoFreezeLength) {
+        lastAutoFreezeSensitivity = value(autoFreezeSensitivity);
+        lastAutoFreezeLength = value(autoFreezeLength);
+        autoFreezeSamples = roundToInt(lastAutoFreezeLength * getSampleRate());
+        onsets.setSensitivity(lastAutoFreezeSensitivity / 100);
+        onsets.setHoldoff(autoFreezeSamples);
+    }
+
+    // legato
+    if ((value(legato) > 0.5f) != lastLegato || roundToInt(value(refreezeController)) != lastRefreezeController) {
+        lastLegato = (value(legato) > 0.5f);
+        lastRefreezeController = roundToInt(value(refreezeController));
+        voice->legatoChanged(lastLegato, lastRefreezeController);
+    }
+
     if (anythingChanged) broadcaster.sendChangeMessage();
 }
 
@@ -264,6 +583,51 @@ void IceboxAudioProcessor::getStateInformation (MemoryBlock& destData)
 
     stream.writeFloat((*wet).get());
     stream.writeFloat((*dry).get());
+
+    stream.writeBool((*granular).get());
+    stream.writeInt((*grainCount).get());
+    stream.writeFloat((*grainLength).get());
+    stream.writeFloat((*grainJitter).get());
+    stream.writeFloat((*grainSpread).get());
+
+    stream.writeBool((*freezeSync).get());
+    stream.writeInt((*freezeGrid).getIndex());
+    stream.writeInt((*freezeLength).getIndex());
+
+    for (int i = 0; i < ModMatrix::numLfos; i++) {
+        stream.writeFloat((*lfoRate[i]).get());
+        stream.writeInt((*lfoShape[i]).getIndex());
+    }
+    stream.writeInt((*modController).get());
+    for (int i = 0; i < ModMatrix::numSlots; i++) {
+        stream.writeInt((*modSource[i]).getIndex());
+        stream.writeInt((*modDestination[i]).getIndex());
+        stream.writeFloat((*modAmount[i]).get());
+    }
+
+    // Formerly the compact storage flag, kept so saved states stay aligned
+    stream.writeBool(false);
+
+    stream.writeFloat((*envelopeCurve).get());
+
+    stream.writeBool((*legato).get());
+    stream.writeInt((*refreezeController).get());
+
+    stream.writeBool((*autoFreeze).get());
+    stream.writeFloat((*autoFreezeSensitivity).get());
+    stream.writeFloat((*autoFreezeLength).get());
+    stream.writeInt((*autoFreezeNote).get());
+
+    stream.writeBool((*spectral).get());
+    stream.writeInt((*spectralSize).getIndex());
+    stream.writeInt((*spectralPhase).getIndex());
+
+    stream.writeInt((*notePriority).getIndex());
+
+    stream.writeInt(freezeBusSetting);
+
+    stream.writeBool((*qualityGovernor).get());
+    stream.writeInt((*freezeLevel).getIndex());
 }
 
 void IceboxAudioProcessor::setStateInformation (const void* data, int sizeInBytes)
@@ -284,6 +648,63 @@ void IceboxAudioProcessor::setStateInformation (const void* data, int sizeInByte
     (*wet).setValueNotifyingHost((*wet).convertTo0to1(stream.readFloat()));
     (*dry).setValueNotifyingHost((*dry).convertTo0to1(stream.readFloat()));
 
+    if (!stream.isExhausted()) {
+        (*granular).setValueNotifyingHost(stream.readBool());
+        (*grainCount).setValueNotifyingHost((*grainCount).convertTo0to1(stream.readInt()));
+        (*grainLength).setValueNotifyingHost((*grainLength).convertTo0to1(stream.readFloat()));
+        (*grainJitter).setValueNotifyingHost((*grainJitter).convertTo0to1(stream.readFloat()));
+        (*grainSpread).setValueNotifyingHost((*grainSpread).convertTo0to1(stream.readFloat()));
+    }
+
+    if (!stream.isExhausted()) {
+        (*freezeSync).setValueNotifyingHost(stream.readBool());
+        (*freezeGrid).setValueNotifyingHost((*freezeGrid).convertTo0to1(stream.readInt()));
+        (*freezeLength).setValueNotifyingHost((*freezeLength).convertTo0to1(stream.readInt()));
+    }
+
+    if (!stream.isExhausted()) {
+        for (int i = 0; i < ModMatrix::numLfos; i++) {
+            (*lfoRate[i]).setValueNotifyingHost((*lfoRate[i]).convertTo0to1(stream.readFloat()));
+            (*lfoShape[i]).setValueNotifyingHost((*lfoShape[i]).convertTo0to1(stream.readInt()));
+        }
+        (*modController).setValueNotifyingHost((*modController).convertTo0to1(stream.readInt()));
+        for (int i = 0; i < ModMatrix::numSlots; i++) {
+            (*modSource[i]).setValueNotifyingHost((*modSource[i]).convertTo0to1(stream.readInt()));
+            (*modDestination[i]).setValueNotifyingHost((*modDestination[i]).convertTo0to1(stream.readInt()));
+            (*modAmount[i]).setValueNotifyingHost((*modAmount[i]).convertTo0to1(stream.readFloat()));
+        }
+    }
+
+    if (!stream.isExhausted()) stream.readBool();
+
+    if (!stream.isExhausted()) (*envelopeCurve).setValueNotifyingHost((*envelopeCurve).convertTo0to1(stream.readFloat()));
+
+    if (!stream.isExhausted()) {
+        (*legato).setValueNotifyingHost(stream.readBool());
+        (*refreezeController).setValueNotifyingHost((*refreezeController).convertTo0to1(stream.readInt()));
+    }
+
+    if (!stream.isExhausted()) {
+        (*autoFreeze).setValueNotifyingHost(stream.readBool());
+        (*autoFreezeSensitivity).setValueNotifyingHost((*autoFreezeSensitivity).convertTo0to1(stream.readFloat()));
+        (*autoFreezeLength).setValueNotifyingHost((*autoFreezeLength).convertTo0to1(stream.readFloat()));
+        (*autoFreezeNote).setValueNotifyingHost((*autoFreezeNote).convertTo0to1(stream.readInt()));
+    }
+
+    if (!stream.isExhausted()) {
+        (*spectral).setValueNotifyingHost(stream.readBool());
+        (*spectralSize).setValueNotifyingHost((*spectralSize).convertTo0to1(stream.readInt()));
+        (*spectralPhase).setValueNotifyingHost((*spectralPhase).convertTo0to1(stream.readInt()));
+    }
+
+    if (!stream.isExhausted()) (*notePriority).setValueNotifyingHost((*notePriority).convertTo0to1(stream.readInt()));
+
+    if (!stream.isExhausted()) setFreezeBus(stream.readInt());
+
+    if (!stream.isExhausted()) (*qualityGovernor).setValueNotifyingHost(stream.readBool());
+
+    if (!stream.isExhausted()) (*freezeLevel).setValueNotifyingHost((*freezeLevel).convertTo0to1(stream.readInt()));
+
     lastFormant = -30;
     lastFormantDecay = -30;
     lastFormantDecayRate = -1;
@@ -293,11 +714,21 @@ void IceboxAudioProcessor::setStateInformation (const void* data, int sizeInByte
     lastDecay = -1;
     lastSustain = -1;
     lastRelease = -1;
+    lastEnvelopeCurve = -1;
 
     lastPortamento = -1;
 
     lastWet = -1;
     lastDry = -1;
+
+    lastGrainCount = -1;
+    lastModController = -1;
+    lastRefreezeController = -1;
+    lastAutoFreezeLength = -1;
+    lastSpectralSize = -1;
+    lastFreezeLevel = -1;
+    modDirty = true;
+    paramsDirty = true;
 }
 
 AudioProcessor* JUCE_CALLTYPE createPluginFilter()
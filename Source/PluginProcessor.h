@@ -2,9 +2,15 @@
 
 #include <JuceHeader.h>
 #include <vector>
-#include "SynthVoice.h"
-#include "SynthSound.h"
-#include "FixedDelayBuffer.h"
+#include "Core/SynthVoice.h"
+#include "Core/FixedDelayBuffer.h"
+#include "Core/OnsetDetector.h"
+#include "VoiceManager.h"
+#include "FreezeBus.h"
+#include "QualityGovernor.h"
+#include "LoopExporter.h"
+#include "OutputRecorder.h"
+#include "ParameterEventQueue.h"
 
 #define DEF_ATTACK 0.01
 #define DEF_DECAY 0
@@ -14,7 +20,7 @@
 //==============================================================================
 /**
 */
-class IceboxAudioProcessor  : public AudioProcessor
+class IceboxAudioProcessor  : public AudioProcessor, private AudioProcessorParameter::Listener
 {
 public:
     //==============================================================================
@@ -24,12 +30,15 @@ public:
     //==============================================================================
     void prepareToPlay (double sampleRate, int samplesPerBlock) override;
     void releaseResources() override;
+    void reset() override;
 
    #ifndef JucePlugin_PreferredChannelConfigurations
     bool isBusesLayoutSupported (const BusesLayout& layouts) const override;
    #endif
 
     void processBlock (AudioBuffer<float>&, MidiBuffer&) override;
+    void processBlock (AudioBuffer<double>&, MidiBuffer&) override;
+    bool supportsDoublePrecisionProcessing() const override { return true; }
 
     //==============================================================================
     AudioProcessorEditor* createEditor() override;
@@ -55,6 +64,13 @@ public:
     void setStateInformation (const void* data, int sizeInBytes) override;
 
     void checkParams(SynthVoice* voice);
+    // 0 is off, 1 to FreezeBus::numChannels send on a channel, the rest receive.
+    // Returns false if another instance already sends on the channel.
+    bool setFreezeBus(int setting);
+    int getFreezeBus() const { return freezeBusSetting; }
+    static StringArray getFreezeBusNames();
+    FreezeSync getFreezeSync();
+    static double noteValueInQuarters(int index);
 
 
     AudioParameterFloat* formant;
@@ -72,6 +88,42 @@ public:
     AudioParameterFloat* wet;
     AudioParameterFloat* dry;
 
+    AudioParameterBool* granular;
+    AudioParameterInt* grainCount;
+    AudioParameterFloat* grainLength;
+    AudioParameterFloat* grainJitter;
+    AudioParameterFloat* grainSpread;
+
+    AudioParameterBool* freezeSync;
+    AudioParameterChoice* freezeGrid;
+    AudioParameterChoice* freezeLength;
+
+    AudioParameterFloat* lfoRate[ModMatrix::numLfos];
+    AudioParameterChoice* lfoShape[ModMatrix::numLfos];
+    AudioParameterInt* modController;
+    AudioParameterChoice* modSource[ModMatrix::numSlots];
+    AudioParameterChoice* modDestination[ModMatrix::numSlots];
+    AudioParameterFloat* modAmount[ModMatrix::numSlots];
+
+    AudioParameterFloat* envelopeCurve;
+
+    AudioParameterBool* legato;
+    AudioParameterInt* refreezeController;
+
+    AudioParameterBool* autoFreeze;
+    AudioParameterFloat* autoFreezeSensitivity;
+    AudioParameterFloat* autoFreezeLength;
+    AudioParameterInt* autoFreezeNote;
+
+    AudioParameterBool* spectral;
+    AudioParameterChoice* spectralSize;
+    AudioParameterChoice* spectralPhase;
+
+    AudioParameterChoice* notePriority;
+
+    AudioParameterBool* qualityGovernor;
+    AudioParameterChoice* freezeLevel;
+
     float lastFormant = -30;
     float lastFormantDecay = -30;
     float lastFormantDecayRate = -1;
@@ -81,18 +133,84 @@ public:
     float lastDecay = -1;
     float lastSustain = -1;
     float lastRelease = -1;
+    float lastEnvelopeCurve = -1;
 
     float lastPortamento = -1;
 
     float lastWet = -1;
     float lastDry = -1;
 
+    bool lastGranular = true;
+    int lastGrainCount = -1;
+    float lastGrainLength = -1;
+    float lastGrainJitter = -1;
+    float lastGrainSpread = -1;
+
+    float lastLfoRate[ModMatrix::numLfos] = {};
+    int lastLfoShape[ModMatrix::numLfos] = {};
+    int lastModController = -1;
+    int lastModSource[ModMatrix::numSlots] = {};
+    int lastModDestination[ModMatrix::numSlots] = {};
+    float lastModAmount[ModMatrix::numSlots] = {};
+    bool modDirty = true;
+
+    bool lastLegato = true;
+    int lastRefreezeController = -1;
+
+    bool lastAutoFreeze = false;
+    float lastAutoFreezeSensitivity = -1;
+    float lastAutoFreezeLength = -1;
+    int lastAutoFreezeNote = 60;
+
+    bool lastSpectral = true;
+    int lastSpectralSize = -1;
+    int lastSpectralPhase = -1;
+
+    bool lastQualityGovernor = false;
+    int lastQualityLevel = 0;
+
+    int lastFreezeLevel = -1;
+
     bool updateMe[11] = { true, true, true, true, true, true, true, true, true, true, true };
 
     ChangeBroadcaster broadcaster;
+    TraceRecorder trace;
+    QualityGovernor governor;
+    LoopExporter exporter;
+    OutputRecorder recorder;
 
 private:
+    template <typename FloatType>
+    void process(AudioBuffer<FloatType>& buffer, MidiBuffer& midiMessages);
+    template <typename FloatType>
+    bool addAutoFreezeEvents(const AudioBuffer<FloatType>& buffer, const MidiBuffer& midiMessages);
+
+    void parameterValueChanged(int parameterIndex, float newValue) override;
+    void parameterGestureChanged(int parameterIndex, bool gestureIsStarting) override {}
+    void applyParameterEvents();
+    void syncParameterValues();
+    float value(const AudioProcessorParameter* parameter) const { return paramValues[(size_t)parameter->getParameterIndex()]; }
+
+    // Audio-thread copy of every parameter, updated from the event queue at the start of each block
+    std::vector<float> paramValues;
+    ParameterEventQueue parameterEvents;
+    std::atomic<Thread::ThreadID> audioThread{ nullptr };
+    std::atomic<bool> paramsDirty{ true };
+    bool paramsChanged = false;
+    void updateStorage();
+
+    SharedResourcePointer<FreezeBus> freezeBus;
+    int freezeBusSetting = 0;
+    SharedCaptureRing* busRing = nullptr;
+    bool busSending = false;
+
+    OnsetDetector onsets;
+    MidiBuffer autoFreezeMidi;
+    int autoFreezeSamples = 0;
+    int autoFreezeCountdown = -1;
+    int autoFreezeHeld = -1;
+
     //==============================================================================
-    Synthesiser synth;
+    VoiceManager synth;
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (IceboxAudioProcessor)
 };
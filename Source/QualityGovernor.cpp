@@ -0,0 +1,56 @@
+#include "QualityGovernor.h"
+
+void QualityGovernor::prepare(double newSampleRate)
+{
+    sampleRate = newSampleRate;
+    ticksPerSecond = (double)Time::getHighResolutionTicksPerSecond();
+    followedLoad = 0;
+    sinceChange = 0;
+    underLowLoad = 0;
+}
+
+void QualityGovernor::setEnabled(bool shouldBeEnabled) noexcept
+{
+    enabled = shouldBeEnabled;
+    if (!enabled) level = 0;
+}
+
+bool QualityGovernor::blockFinished(int numSamples, int64 elapsedTicks) noexcept
+{
+    if (!enabled || numSamples <= 0) return false;
+
+    double seconds = numSamples / sampleRate;
+    float load = (float)(elapsedTicks / ticksPerSecond / seconds);
+    followedLoad = jmax(load, followedLoad - releasePerSecond * (float)seconds);
+    sinceChange += seconds;
+    underLowLoad = followedLoad < lowLoad ? underLowLoad + seconds : 0;
+
+    int newLevel = level;
+    if (sinceChange >= dwellSeconds) {
+        if (followedLoad > highLoad) newLevel = jmin(level + 1, numLevels - 1);
+        else if (underLowLoad >= recoverSeconds) newLevel = jmax(level - 1, 0);
+    }
+    if (newLevel == level) return false;
+
+    int start1, size1, start2, size2;
+    fifo.prepareToWrite(1, start1, size1, start2, size2);
+    if (size1 + size2 > 0) {
+        decisions[(size_t)(size1 > 0 ? start1 : start2)] = { Time::currentTimeMillis(), level, newLevel, followedLoad };
+        fifo.finishedWrite(1);
+    }
+
+    level = newLevel;
+    sinceChange = 0;
+    underLowLoad = 0;
+    return true;
+}
+
+bool QualityGovernor::popDecision(Decision& decision) noexcept
+{
+    int start1, size1, start2, size2;
+    fifo.prepareToRead(1, start1, size1, start2, size2);
+    if (size1 + size2 == 0) return false;
+    decision = decisions[(size_t)(size1 > 0 ? start1 : start2)];
+    fifo.finishedRead(1);
+    return true;
+}
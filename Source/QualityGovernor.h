@@ -0,0 +1,58 @@
+#pragma once
+#include <JuceHeader.h>
+#include "Core/GrainCloud.h"
+#include "Core/SpectralFreeze.h"
+
+// Steps the engine's quality down when processBlock runs close to its deadline and
+// back up once there is headroom again. Load is the block's processing time over
+// its duration, followed with instant attack and slow release; the level drops when
+// the followed load passes highLoad and rises only after it has stayed under
+// lowLoad for recoverSeconds, with at least dwellSeconds between any two changes.
+// Each level caps the grain count and spectral FFT size; the engine fades between
+// grain counts and changes FFT size only at the next freeze, so switching is silent.
+class QualityGovernor
+{
+public:
+    static constexpr int numLevels = 4;
+    static constexpr float highLoad = 0.7f;
+    static constexpr float lowLoad = 0.35f;
+    static constexpr double dwellSeconds = 0.5;
+    static constexpr double recoverSeconds = 3;
+
+    // What a level allows; level 0 is whatever the parameters ask for
+    static int getGrainLimit(int level) noexcept { return level == 0 ? GrainCloud::maxGrains : 16 >> level; }
+    static int getSpectralSizeLimit(int level) noexcept { return SpectralFreeze::numSizes - 1 - level; }
+
+    struct Decision
+    {
+        int64 time;   // Time::currentTimeMillis() when the audio thread decided
+        int from;
+        int to;
+        float load;
+    };
+
+    void prepare(double sampleRate);
+    void setEnabled(bool shouldBeEnabled) noexcept;
+    int getLevel() const noexcept { return level; }
+
+    // Audio thread, once per block. Returns true when the level changed.
+    bool blockFinished(int numSamples, int64 elapsedTicks) noexcept;
+
+    // Any single other thread, e.g. to log decisions
+    bool popDecision(Decision& decision) noexcept;
+
+private:
+    static constexpr int decisionCapacity = 64;
+
+    bool enabled = false;
+    int level = 0;
+    double sampleRate = 44100;
+    double ticksPerSecond = 1;
+    float followedLoad = 0;
+    float releasePerSecond = 0.5f;
+    double sinceChange = 0;
+    double underLowLoad = 0;
+
+    AbstractFifo fifo{ decisionCapacity };
+    std::array<Decision, decisionCapacity> decisions;
+};
@@ -1,10 +0,0 @@
-#pragma once
-
-#include <JuceHeader.h>
-
-class SynthSound : public SynthesiserSound
-{
-public:
-    bool appliesToNote(int midiNoteNumber) override { return true; }
-    bool appliesToChannel(int midiChannel) override { return true; }
-};
\ No newline at end of file
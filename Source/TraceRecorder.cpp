@@ -0,0 +1,62 @@
+#include "TraceRecorder.h"
+
+bool TraceRecorder::start(const File& file)
+{
+    if (isThreadRunning()) return true;
+
+    file.deleteFile();
+    stream = std::make_unique<FileOutputStream>(file);
+    if (stream->failedToOpen()) {
+        stream.reset();
+        return false;
+    }
+    *stream << "{\"traceEvents\":[";
+
+    // Discard anything left from a scope that outlived the previous recording
+    fifo.finishedRead(fifo.getNumReady());
+    startTicks = Time::getHighResolutionTicks();
+    firstEvent = true;
+    dropped = 0;
+    recording = true;
+    startThread();
+    return true;
+}
+
+void TraceRecorder::stop()
+{
+    if (!isThreadRunning()) return;
+
+    recording = false;
+    stopThread(2000);
+    *stream << "],\"displayTimeUnit\":\"ms\",\"otherData\":{\"dropped\":" << getNumDropped() << "}}";
+    stream->flush();
+    stream.reset();
+}
+
+void TraceRecorder::run()
+{
+    while (!threadShouldExit()) {
+        drain();
+        wait(20);
+    }
+    drain();
+}
+
+void TraceRecorder::drain()
+{
+    double ticksPerMicrosecond = Time::getHighResolutionTicksPerSecond() / 1.0e6;
+    int start1, size1, start2, size2;
+    fifo.prepareToRead(fifo.getNumReady(), start1, size1, start2, size2);
+
+    for (int block = 0; block < 2; block++) {
+        int start = block == 0 ? start1 : start2;
+        int size = block == 0 ? size1 : size2;
+        for (int i = start; i < start + size; i++) {
+            const auto& event = events[(size_t)i];
+            *stream << (firstEvent ? "" : ",") << "{\"name\":\"" << event.name << "\",\"ph\":\"" << event.phase
+                << "\",\"ts\":" << (event.ticks - startTicks) / ticksPerMicrosecond << ",\"pid\":1,\"tid\":1}";
+            firstEvent = false;
+        }
+    }
+    fifo.finishedRead(size1 + size2);
+}
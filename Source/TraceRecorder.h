@@ -0,0 +1,73 @@
+#pragma once
+#include <JuceHeader.h>
+
+// Begin/end timeline of the audio thread's work, written as Chrome trace JSON for
+// chrome://tracing or ui.perfetto.dev. The audio thread is the only writer to the
+// ring; a background thread drains it into the file while recording. When not
+// recording a Scope costs one relaxed load and branch, so it stays compiled in.
+class TraceRecorder : private Thread
+{
+public:
+    static constexpr int capacity = 8192;
+
+    // Names must outlive the recording; pass string literals
+    struct Scope
+    {
+        Scope(TraceRecorder& r, const char* n) noexcept : Scope(&r, n) {}
+
+        // Records nothing when there is no recorder
+        Scope(TraceRecorder* r, const char* n) noexcept : recorder(r != nullptr && r->isRecording() ? r : nullptr), name(n)
+        {
+            if (recorder != nullptr) recorder->add(name, "B");
+        }
+        ~Scope()
+        {
+            if (recorder != nullptr) recorder->add(name, "E");
+        }
+
+        TraceRecorder* recorder;
+        const char* name;
+    };
+
+    TraceRecorder() : Thread("Icebox Trace") {}
+    ~TraceRecorder() override { stop(); }
+
+    // Message thread only
+    bool start(const File& file);
+    void stop();
+
+    bool isRecording() const noexcept { return recording.load(std::memory_order_relaxed); }
+    int getNumDropped() const noexcept { return dropped.load(); }
+
+private:
+    struct Event
+    {
+        const char* name;
+        int64 ticks;
+        const char* phase;
+    };
+
+    void add(const char* name, const char* phase) noexcept
+    {
+        int start1, size1, start2, size2;
+        fifo.prepareToWrite(1, start1, size1, start2, size2);
+        if (size1 + size2 == 0) {
+            dropped++;
+            return;
+        }
+        events[(size_t)(size1 > 0 ? start1 : start2)] = { name, Time::getHighResolutionTicks(), phase };
+        fifo.finishedWrite(1);
+    }
+
+    void run() override;
+    void drain();
+
+    AbstractFifo fifo{ capacity };
+    std::array<Event, capacity> events;
+    std::atomic<bool> recording{ false };
+    std::atomic<int> dropped{ 0 };
+
+    std::unique_ptr<FileOutputStream> stream;
+    int64 startTicks = 0;
+    bool firstEvent = true;
+};
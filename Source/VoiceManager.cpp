@@ -0,0 +1,190 @@
+#include "VoiceManager.h"
+
+void VoiceManager::addVoice(std::unique_ptr<SynthVoice> voice)
+{
+    voices.push_back(std::move(voice));
+    voiceAges.push_back(0);
+}
+
+void VoiceManager::setCurrentPlaybackSampleRate(double sampleRate)
+{
+    allNotesOff(false);
+    for (auto& voice : voices)
+        voice->setCurrentPlaybackSampleRate(sampleRate);
+}
+
+void VoiceManager::allNotesOff(bool allowTailOff) noexcept
+{
+    for (auto& voice : voices) {
+        voice->setKeyDown(false);
+        if (voice->isVoiceActive()) voice->stopNote(1.f, allowTailOff);
+    }
+    numHeld = 0;
+    sustainDown = false;
+}
+
+void VoiceManager::handleMidiEvent(const uint8* data, int numBytes) noexcept
+{
+    if (numBytes < 1 || data[0] >= 0xf0) return;
+    int type = data[0] & 0xf0;
+    int first = numBytes > 1 ? data[1] : 0;
+    int second = numBytes > 2 ? data[2] : 0;
+
+    switch (type) {
+    case 0x90:
+        if (second > 0) noteOn(first, second / 127.f);
+        else noteOff(first, 0);
+        break;
+    case 0x80:
+        noteOff(first, second / 127.f);
+        break;
+    case 0xa0: {
+        int index = findVoice(first);
+        if (index >= 0) voices[(size_t)index]->aftertouchChanged(second);
+        break;
+    }
+    case 0xb0:
+        if (first == 64) sustainPedal(second >= 64);
+        else if (first == 120) allNotesOff(false);
+        else if (first == 123) allNotesOff(true);
+        for (auto& voice : voices)
+            voice->controllerMoved(first, second);
+        break;
+    case 0xd0:
+        for (auto& voice : voices)
+            voice->channelPressureChanged(first);
+        break;
+    case 0xe0:
+        pitchWheel = first | (second << 7);
+        for (auto& voice : voices)
+            voice->pitchWheelMoved(pitchWheel);
+        break;
+    default:
+        break;
+    }
+}
+
+void VoiceManager::noteOn(int note, float velocity) noexcept
+{
+    // A re-struck key moves to the back of the press order and restarts its voice
+    int position = heldPosition(note);
+    if (position >= 0) {
+        std::copy(held.begin() + position + 1, held.begin() + numHeld, held.begin() + position);
+        numHeld--;
+    }
+    held[(size_t)numHeld++] = note;
+    heldVelocity[(size_t)note] = velocity;
+
+    int index = findVoice(note);
+    if (index >= 0) voices[(size_t)index]->setKeyDown(false);
+    else index = findVoiceToSteal(note);
+    if (index >= 0) startVoice(index, note, velocity);
+}
+
+void VoiceManager::noteOff(int note, float velocity) noexcept
+{
+    int position = heldPosition(note);
+    if (position >= 0) {
+        std::copy(held.begin() + position + 1, held.begin() + numHeld, held.begin() + position);
+        numHeld--;
+    }
+
+    int index = findVoice(note);
+    if (index < 0 || !voices[(size_t)index]->isKeyDown()) return;
+
+    // Hand the voice to a held key that lost out earlier, gliding there in legato mode
+    int waiting = findWaitingNote();
+    if (waiting >= 0) {
+        startVoice(index, waiting, heldVelocity[(size_t)waiting]);
+        return;
+    }
+
+    auto& voice = *voices[(size_t)index];
+    voice.setKeyDown(false);
+    if (!sustainDown) voice.stopNote(velocity, true);
+}
+
+void VoiceManager::sustainPedal(bool isDown) noexcept
+{
+    sustainDown = isDown;
+    if (isDown) return;
+
+    for (auto& voice : voices) {
+        if (voice->isVoiceActive() && !voice->isKeyDown()) voice->stopNote(1.f, true);
+    }
+}
+
+void VoiceManager::startVoice(int index, int note, float velocity) noexcept
+{
+    auto& voice = *voices[(size_t)index];
+    if (voice.isVoiceActive()) voice.stopNote(0, false);
+    voice.setKeyDown(true);
+    voiceAges[(size_t)index] = ++nextAge;
+    TraceRecorder::Scope scope(trace, "noteOn");
+    voice.startNote(note, velocity, pitchWheel);
+}
+
+int VoiceManager::findVoice(int note) const noexcept
+{
+    for (size_t i = 0; i < voices.size(); i++) {
+        if (voices[i]->getCurrentlyPlayingNote() == note) return (int)i;
+    }
+    return -1;
+}
+
+// A free voice if there is one, then (policy permitting) a released one, then the
+// held voice ranked lowest among those the new note outranks; -1 if the note loses
+int VoiceManager::findVoiceToSteal(int note) const noexcept
+{
+    int best = -1;
+    for (size_t i = 0; i < voices.size(); i++) {
+        if (!voices[i]->isVoiceActive()) return (int)i;
+    }
+
+    if (stealing == releasedFirst) {
+        for (size_t i = 0; i < voices.size(); i++) {
+            if (!voices[i]->isKeyDown() && (best < 0 || voiceAges[i] < voiceAges[(size_t)best])) best = (int)i;
+        }
+        if (best >= 0) return best;
+    }
+
+    for (size_t i = 0; i < voices.size(); i++) {
+        int playing = voices[i]->getCurrentlyPlayingNote();
+        if (voices[i]->isKeyDown() && !outranks(note, playing)) continue;
+        if (best < 0) best = (int)i;
+        else if (stealing == oldest) {
+            if (voiceAges[i] < voiceAges[(size_t)best]) best = (int)i;
+        }
+        else if (outranks(voices[(size_t)best]->getCurrentlyPlayingNote(), playing)) best = (int)i;
+    }
+    return best;
+}
+
+// The highest-ranked held key that has no voice
+int VoiceManager::findWaitingNote() const noexcept
+{
+    int best = -1;
+    for (int i = 0; i < numHeld; i++) {
+        int note = held[(size_t)i];
+        if (findVoice(note) < 0 && (best < 0 || outranks(note, best))) best = note;
+    }
+    return best;
+}
+
+bool VoiceManager::outranks(int note, int other) const noexcept
+{
+    switch (priority) {
+    case firstNote: return heldPosition(note) < heldPosition(other) && heldPosition(note) >= 0;
+    case lowestNote: return note < other;
+    case highestNote: return note > other;
+    default: return heldPosition(note) > heldPosition(other);
+    }
+}
+
+int VoiceManager::heldPosition(int note) const noexcept
+{
+    for (int i = 0; i < numHeld; i++) {
+        if (held[(size_t)i] == note) return i;
+    }
+    return -1;
+}
@@ -0,0 +1,83 @@
+#pragma once
+#include <JuceHeader.h>
+#include <vector>
+#include "Core/SynthVoice.h"
+#include "TraceRecorder.h"
+
+// Replacement for juce::Synthesiser specialised for SynthVoice. There is no lock
+// and no virtual dispatch: MIDI is read straight from the buffer's bytes, voices
+// are called directly, and each block is split exactly at its events. Voices are
+// added before processing starts; everything else runs on the audio thread. The
+// trace recorder is optional. How its cost compares with juce::Synthesiser has not
+// been measured in a JUCE build; the benchmark's `voices` suite compares the two.
+class VoiceManager
+{
+public:
+    // Which notes keep sounding when more keys are held than there are voices
+    enum Priority { lastNote, firstNote, lowestNote, highestNote };
+    // Which voice gives way when a note wins by priority
+    enum Stealing { releasedFirst, oldest };
+
+    static StringArray getPriorityNames() { return { "Last", "First", "Lowest", "Highest" }; }
+
+    void addVoice(std::unique_ptr<SynthVoice> voice);
+    int getNumVoices() const noexcept { return (int)voices.size(); }
+    SynthVoice* getVoice(int index) const noexcept { return voices[(size_t)index].get(); }
+
+    void setCurrentPlaybackSampleRate(double sampleRate);
+    void setTraceRecorder(TraceRecorder* recorder) noexcept { trace = recorder; }
+    void setNotePriority(int newPriority) noexcept { priority = newPriority; }
+    void setStealing(int newStealing) noexcept { stealing = newStealing; }
+    void allNotesOff(bool allowTailOff) noexcept;
+
+    template <typename T>
+    void renderNextBlock(AudioBuffer<T>& buffer, const MidiBuffer& midi, int startSample, int numSamples)
+    {
+        int end = startSample + numSamples;
+        for (auto it = midi.findNextSamplePosition(startSample); it != midi.end(); ++it) {
+            const auto event = *it;
+            if (event.samplePosition >= end) break;
+            if (event.samplePosition > startSample) {
+                renderVoices(buffer, startSample, event.samplePosition - startSample);
+                startSample = event.samplePosition;
+            }
+            handleMidiEvent(event.data, event.numBytes);
+        }
+        if (startSample < end) renderVoices(buffer, startSample, end - startSample);
+    }
+
+private:
+    template <typename T>
+    void renderVoices(AudioBuffer<T>& buffer, int startSample, int numSamples)
+    {
+        TraceRecorder::Scope scope(trace, "render");
+        for (auto& voice : voices)
+            voice->renderNextBlock(buffer.getWritePointer(0), buffer.getWritePointer(1), startSample, numSamples);
+    }
+
+    void handleMidiEvent(const uint8* data, int numBytes) noexcept;
+    void noteOn(int note, float velocity) noexcept;
+    void noteOff(int note, float velocity) noexcept;
+    void sustainPedal(bool isDown) noexcept;
+    void startVoice(int index, int note, float velocity) noexcept;
+    int findVoice(int note) const noexcept;
+    int findVoiceToSteal(int note) const noexcept;
+    int findWaitingNote() const noexcept;
+    bool outranks(int note, int other) const noexcept;
+    int heldPosition(int note) const noexcept;
+
+    std::vector<std::unique_ptr<SynthVoice>> voices;
+    TraceRecorder* trace = nullptr;
+    std::vector<uint32> voiceAges;
+    uint32 nextAge = 0;
+
+    // Held keys in the order they were pressed
+    std::array<int, 128> held{};
+    int numHeld = 0;
+    std::array<float, 128> heldVelocity{};
+
+    int priority = lastNote;
+    int stealing = releasedFirst;
+    bool sustainDown = false;
+    int pitchWheel = 8192;
+};
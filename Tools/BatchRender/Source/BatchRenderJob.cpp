@@ -0,0 +1,105 @@
+#include "BatchRenderJob.h"
+#include "../../../Source/PluginProcessor.h"
+
+// Steady tempo from the start of the file, so freeze sync works offline
+struct FixedTempoPlayHead : public AudioPlayHead
+{
+    Optional<PositionInfo> getPosition() const override
+    {
+        PositionInfo info;
+        info.setBpm(bpm);
+        info.setTimeInSamples(samplePosition);
+        info.setTimeInSeconds(samplePosition / sampleRate);
+        info.setPpqPosition(samplePosition / sampleRate * bpm / 60);
+        info.setIsPlaying(true);
+        return info;
+    }
+
+    double bpm = 120;
+    double sampleRate = 44100;
+    int64 samplePosition = 0;
+};
+
+BatchRenderJob::BatchRenderJob(const File& inputFile, const File& outputFile, const MidiMessageSequence& noteEvents, const Settings& renderSettings)
+    : ThreadPoolJob(inputFile.getFileName()), input(inputFile), output(outputFile), events(noteEvents), settings(renderSettings)
+{
+}
+
+ThreadPoolJob::JobStatus BatchRenderJob::runJob()
+{
+    double start = Time::getMillisecondCounterHiRes();
+    error = render();
+    busySeconds = (Time::getMillisecondCounterHiRes() - start) / 1000;
+    return jobHasFinished;
+}
+
+String BatchRenderJob::render()
+{
+    AudioFormatManager formats;
+    formats.registerBasicFormats();
+    std::unique_ptr<AudioFormatReader> reader(formats.createReaderFor(input));
+    if (reader == nullptr) return "unreadable audio file";
+
+    double sampleRate = reader->sampleRate;
+    int blockSize = settings.blockSize;
+    int64 length = reader->lengthInSamples + (int64)std::ceil(settings.tailSeconds * sampleRate);
+
+    // WAV takes 8, 16, 24 or 32 bits; anything else (or float input) is written as 32-bit float
+    int bits = reader->usesFloatingPointData ? 32 : (int)reader->bitsPerSample;
+    if (bits != 8 && bits != 16 && bits != 24) bits = 32;
+
+    output.deleteFile();
+    std::unique_ptr<FileOutputStream> stream(output.createOutputStream());
+    if (stream == nullptr) return "can't write " + output.getFullPathName();
+    WavAudioFormat wav;
+    std::unique_ptr<AudioFormatWriter> writer(wav.createWriterFor(stream.get(), sampleRate, 2, bits, {}, 0));
+    if (writer == nullptr) return "can't create a WAV writer";
+    stream.release();
+
+    IceboxAudioProcessor processor;
+    if (settings.preset.getSize() > 0)
+        processor.setStateInformation(settings.preset.getData(), (int)settings.preset.getSize());
+
+    FixedTempoPlayHead playHead;
+    playHead.bpm = settings.bpm;
+    playHead.sampleRate = sampleRate;
+    if (settings.bpm > 0) processor.setPlayHead(&playHead);
+
+    processor.setPlayConfigDetails(2, 2, sampleRate, blockSize);
+    processor.setNonRealtime(true);
+    processor.prepareToPlay(sampleRate, blockSize);
+
+    for (int i = 0; i < events.getNumEvents(); i++) {
+        auto& message = events.getEventPointer(i)->message;
+        message.setTimeStamp(std::round(message.getTimeStamp() * sampleRate));
+    }
+
+    AudioBuffer<float> block(2, blockSize);
+    MidiBuffer midi;
+    int nextEvent = 0;
+    for (int64 position = 0; position < length; position += blockSize) {
+        if (shouldExit()) return "cancelled";
+
+        int n = (int)jmin((int64)blockSize, length - position);
+        block.setSize(2, n, false, false, true);
+        block.clear();
+        reader->read(&block, 0, n, position, true, true);
+        if (reader->numChannels == 1) block.copyFrom(1, 0, block, 0, 0, n);
+
+        midi.clear();
+        for (; nextEvent < events.getNumEvents(); nextEvent++) {
+            auto& message = events.getEventPointer(nextEvent)->message;
+            int64 time = (int64)message.getTimeStamp();
+            if (time >= position + n) break;
+            midi.addEvent(message, (int)jmax((int64)0, time - position));
+        }
+
+        playHead.samplePosition = position;
+        processor.processBlock(block, midi);
+        if (!writer->writeFromAudioSampleBuffer(block, 0, n)) return "write failed";
+    }
+
+    processor.releaseResources();
+    audioSeconds = length / sampleRate;
+    return {};
+}
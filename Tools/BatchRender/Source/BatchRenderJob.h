@@ -0,0 +1,40 @@
+#pragma once
+#include <JuceHeader.h>
+
+// Renders one stem through a private IceboxAudioProcessor, streaming the input file
+// through the plugin a block at a time and straight out to a WAV. Each job owns all
+// of its state, so the output is the same whichever thread, and however many
+// threads, run it.
+class BatchRenderJob : public ThreadPoolJob
+{
+public:
+    struct Settings
+    {
+        MemoryBlock preset;
+        int blockSize = 512;
+        double tailSeconds = 0;
+        double bpm = 0;
+    };
+
+    // Events are timestamped in seconds
+    BatchRenderJob(const File& inputFile, const File& outputFile, const MidiMessageSequence& noteEvents, const Settings& renderSettings);
+
+    JobStatus runJob() override;
+
+    const File& getInputFile() const noexcept { return input; }
+    const String& getError() const noexcept { return error; }
+    double getAudioSeconds() const noexcept { return audioSeconds; }
+    double getBusySeconds() const noexcept { return busySeconds; }
+
+private:
+    String render();
+
+    File input;
+    File output;
+    MidiMessageSequence events;
+    const Settings& settings;
+
+    String error;
+    double audioSeconds = 0;
+    double busySeconds = 0;
+};
@@ -0,0 +1,144 @@
+#include <JuceHeader.h>
+#include "BatchRenderJob.h"
+
+// Note lists are text, one note per line: start (s), MIDI note, length (s), optional
+// velocity 0-1. Anything after '#' is a comment.
+static MidiMessageSequence loadNoteList(const File& file)
+{
+    MidiMessageSequence sequence;
+    StringArray lines;
+    lines.addLines(file.loadFileAsString());
+    for (int i = 0; i < lines.size(); i++) {
+        auto line = lines[i].upToFirstOccurrenceOf("#", false, false).trim();
+        if (line.isEmpty()) continue;
+
+        StringArray tokens;
+        tokens.addTokens(line, " \t,", "");
+        tokens.removeEmptyStrings();
+        if (tokens.size() < 3)
+            ConsoleApplication::fail(file.getFileName() + ":" + String(i + 1) + ": expected <start> <note> <length> [velocity]");
+
+        double start = tokens[0].getDoubleValue();
+        int note = jlimit(0, 127, tokens[1].getIntValue());
+        double length = tokens[2].getDoubleValue();
+        float velocity = tokens.size() > 3 ? jlimit(0.f, 1.f, tokens[3].getFloatValue()) : 1.f;
+        sequence.addEvent(MidiMessage::noteOn(1, note, velocity), start);
+        sequence.addEvent(MidiMessage::noteOff(1, note), start + length);
+    }
+    sequence.sort();
+    return sequence;
+}
+
+static MidiMessageSequence loadEvents(const File& file)
+{
+    if (!file.hasFileExtension("mid;midi")) return loadNoteList(file);
+
+    FileInputStream in(file);
+    MidiFile midiFile;
+    if (!in.openedOk() || !midiFile.readFrom(in))
+        ConsoleApplication::fail("can't read MIDI file " + file.getFullPathName());
+    midiFile.convertTimestampTicksToSeconds();
+
+    MidiMessageSequence sequence;
+    for (int t = 0; t < midiFile.getNumTracks(); t++)
+        sequence.addSequence(*midiFile.getTrack(t), 0);
+    return sequence;
+}
+
+// A stem's own <name>.mid or <name>.txt beats the shared events
+static MidiMessageSequence eventsForStem(const File& stem, const MidiMessageSequence& shared)
+{
+    for (auto extension : { ".mid", ".midi", ".txt" }) {
+        auto file = stem.withFileExtension(extension);
+        if (file.existsAsFile()) return loadEvents(file);
+    }
+    return shared;
+}
+
+static void run(const ArgumentList& args)
+{
+    File inputFolder = args.getExistingFolderForOption("--input");
+    File outputFolder = args.getFileForOption("--output");
+    if (!outputFolder.createDirectory())
+        ConsoleApplication::fail("can't create " + outputFolder.getFullPathName());
+
+    BatchRenderJob::Settings settings;
+    if (args.containsOption("--preset"))
+        args.getExistingFileForOption("--preset").loadFileAsData(settings.preset);
+    if (args.containsOption("--block"))
+        settings.blockSize = jlimit(16, 8192, args.getValueForOption("--block").getIntValue());
+    if (args.containsOption("--tail"))
+        settings.tailSeconds = jmax(0., args.getValueForOption("--tail").getDoubleValue());
+    if (args.containsOption("--bpm"))
+        settings.bpm = jmax(0., args.getValueForOption("--bpm").getDoubleValue());
+
+    int numThreads = SystemStats::getNumCpus();
+    if (args.containsOption("--threads"))
+        numThreads = jmax(1, args.getValueForOption("--threads").getIntValue());
+
+    MidiMessageSequence shared;
+    if (args.containsOption("--midi")) shared = loadEvents(args.getExistingFileForOption("--midi"));
+    else if (args.containsOption("--notes")) shared = loadEvents(args.getExistingFileForOption("--notes"));
+
+    AudioFormatManager formats;
+    formats.registerBasicFormats();
+    auto stems = inputFolder.findChildFiles(File::findFiles, false, formats.getWildcardForAllFormats());
+    if (stems.isEmpty()) ConsoleApplication::fail("no audio files in " + inputFolder.getFullPathName());
+
+    // Longest first, so the last jobs to start are short and every core stays busy to the end
+    std::sort(stems.begin(), stems.end(), [](const File& a, const File& b) { return a.getSize() > b.getSize(); });
+
+    OwnedArray<BatchRenderJob> jobs;
+    for (auto& stem : stems) {
+        auto output = outputFolder.getChildFile(stem.getFileNameWithoutExtension() + ".wav");
+        jobs.add(new BatchRenderJob(stem, output, eventsForStem(stem, shared), settings));
+    }
+
+    std::cout << "Rendering " << jobs.size() << " files on " << numThreads << " threads" << std::endl;
+    double start = Time::getMillisecondCounterHiRes();
+
+    // Idle workers take the next queued file, so uneven stem lengths balance themselves
+    ThreadPool pool(numThreads);
+    for (auto* job : jobs) pool.addJob(job, false);
+
+    double audioSeconds = 0, busySeconds = 0;
+    int failed = 0;
+    for (auto* job : jobs) {
+        pool.waitForJobToFinish(job, -1);
+        if (job->getError().isNotEmpty()) {
+            std::cout << "FAILED " << job->getInputFile().getFileName() << ": " << job->getError() << std::endl;
+            failed++;
+            continue;
+        }
+        audioSeconds += job->getAudioSeconds();
+        busySeconds += job->getBusySeconds();
+        std::cout << job->getInputFile().getFileName() << "  "
+                  << String(job->getAudioSeconds() / jmax(1.0e-9, job->getBusySeconds()), 1) << "x realtime" << std::endl;
+    }
+
+    double wallSeconds = (Time::getMillisecondCounterHiRes() - start) / 1000;
+    std::cout << std::endl
+              << "Rendered " << String(audioSeconds, 1) << " s of audio in " << String(wallSeconds, 2) << " s" << std::endl
+              << "Throughput: " << String(audioSeconds / jmax(1.0e-9, wallSeconds), 1) << "x realtime overall, "
+              << String(audioSeconds / jmax(1.0e-9, busySeconds), 1) << "x realtime per core" << std::endl;
+
+    if (failed > 0) ConsoleApplication::fail(String(failed) + " of " + String(jobs.size()) + " files failed");
+}
+
+int main(int argc, char* argv[])
+{
+    ScopedJuceInitialiser_GUI juce;
+
+    ConsoleApplication app;
+    app.addHelpCommand("--help|-h", "Icebox batch renderer", true);
+    app.addDefaultCommand({ "",
+                            "--input <folder> --output <folder> [--preset <file>] [--midi <file> | --notes <file>] "
+                            "[--threads <n>] [--block <samples>] [--tail <seconds>] [--bpm <tempo>]",
+                            "Renders every audio file in a folder through Icebox",
+                            "Each file is played into its own Icebox instance with the preset's state (as saved by "
+                            "the plugin's getStateInformation) and the shared MIDI file or note list, unless a "
+                            "<name>.mid or <name>.txt sits beside it. Output is stereo WAV, one file per input, "
+                            "and is identical for any thread count.",
+                            run });
+    return app.findAndRunCommand(argc, argv);
+}
@@ -0,0 +1,117 @@
+#include "Benchmark.h"
+#include "../../../Source/Core/CoreRandom.h"
+
+#if JUCE_LINUX
+ #include <linux/perf_event.h>
+ #include <sys/ioctl.h>
+ #include <sys/syscall.h>
+ #include <unistd.h>
+#endif
+
+namespace Benchmark
+{
+    static volatile double sink = 0;
+
+    void keep(double value) noexcept
+    {
+        sink = sink + value;
+    }
+
+#if JUCE_LINUX
+    static int openCounter(uint32 type, uint64 config)
+    {
+        perf_event_attr attributes{};
+        attributes.size = sizeof(attributes);
+        attributes.type = type;
+        attributes.config = config;
+        attributes.disabled = 1;
+        attributes.exclude_kernel = 1;
+        attributes.exclude_hv = 1;
+        return (int)syscall(SYS_perf_event_open, &attributes, 0, -1, -1, 0);
+    }
+
+    HardwareCounters::HardwareCounters()
+    {
+        events[0] = openCounter(PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS);
+        events[1] = openCounter(PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16));
+        events[2] = openCounter(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES);
+    }
+
+    HardwareCounters::~HardwareCounters()
+    {
+        for (int event : events)
+            if (event >= 0) close(event);
+    }
+
+    void HardwareCounters::start() noexcept
+    {
+        for (int event : events) {
+            if (event < 0) continue;
+            ioctl(event, PERF_EVENT_IOC_RESET, 0);
+            ioctl(event, PERF_EVENT_IOC_ENABLE, 0);
+        }
+    }
+
+    CounterReading HardwareCounters::stop() noexcept
+    {
+        CounterReading reading;
+        double* counts[] = { &reading.instructions, &reading.l1Misses, &reading.cacheMisses };
+        reading.valid = true;
+        for (int i = 0; i < 3; i++) {
+            uint64 count = 0;
+            if (events[i] < 0) {
+                reading.valid = false;
+                continue;
+            }
+            ioctl(events[i], PERF_EVENT_IOC_DISABLE, 0);
+            if (read(events[i], &count, sizeof(count)) != (ssize_t)sizeof(count)) reading.valid = false;
+            *counts[i] = (double)count;
+        }
+        return reading;
+    }
+#else
+    HardwareCounters::HardwareCounters() {}
+    HardwareCounters::~HardwareCounters() {}
+    void HardwareCounters::start() noexcept {}
+    CounterReading HardwareCounters::stop() noexcept { return {}; }
+#endif
+
+    void printHeading(const String& title)
+    {
+        std::cout << std::endl << title << std::endl;
+    }
+
+    void printResult(const String& name, double value, const String& unit, const String& note)
+    {
+        std::cout << "  " << name.paddedRight(' ', 40) << String(value, 2).paddedLeft(' ', 10) << " " << unit;
+        if (note.isNotEmpty()) std::cout << "  (" << note << ")";
+        std::cout << std::endl;
+    }
+
+    VoiceRig::VoiceRig(double sampleRate, int blockSize, bool doublePrecision)
+    {
+        synth.setTraceRecorder(&trace);
+        synth.addVoice(std::make_unique<SynthVoice>(96000));
+        voice = synth.getVoice(0);
+        synth.setCurrentPlaybackSampleRate(sampleRate);
+        voice->prepareToPlay(sampleRate, blockSize, 2, doublePrecision);
+        voice->setStorage(doublePrecision, nullptr);
+        voice->formantChanged(0);
+        voice->formantEnvelopeChanged(0, 0.01f, false);
+        voice->adsrChanged(0.01f, 0, 1, 0.1f, 0);
+        voice->wetDryChanged(1, 0);
+        voice->resetState();
+    }
+
+    void fillInput(AudioBuffer<float>& buffer, double sampleRate)
+    {
+        const double twoPi = 6.283185307179586;
+        CoreRandom random(1234);
+        for (int i = 0; i < buffer.getNumSamples(); i++) {
+            float noise = 0.05f * (random.nextFloat() * 2 - 1);
+            float value = (float)(0.4 * std::sin(twoPi * 220 * i / sampleRate) + 0.2 * std::sin(twoPi * 1375 * i / sampleRate));
+            buffer.getWritePointer(0)[i] = value + noise;
+            buffer.getWritePointer(1)[i] = value - noise;
+        }
+    }
+}
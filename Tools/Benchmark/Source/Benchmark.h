@@ -0,0 +1,94 @@
+#pragma once
+#include <JuceHeader.h>
+#include "../../../Source/VoiceManager.h"
+
+// Shared pieces of the benchmark suites. Each suite prints one line per case, and
+// every time is the fastest of several runs, which keeps scheduler noise out.
+namespace Benchmark
+{
+    // Nanoseconds per call of body, timed over `calls` calls per run
+    template <typename Body>
+    double nanosecondsPerCall(int calls, Body&& body, int runs = 7)
+    {
+        double best = 0;
+        for (int run = 0; run < runs; run++) {
+            int64 begin = Time::getHighResolutionTicks();
+            for (int i = 0; i < calls; i++) body();
+            double seconds = (Time::getHighResolutionTicks() - begin) / Time::getHighResolutionTicksPerSecond();
+            double ns = seconds * 1.0e9 / calls;
+            if (run == 0 || ns < best) best = ns;
+        }
+        return best;
+    }
+
+    // Stops the compiler from dropping work whose result is never used
+    void keep(double value) noexcept;
+
+    // Instruction and cache miss counts over a stretch of code, from Linux perf
+    // events. Elsewhere, or where the kernel or a VM doesn't expose the counters,
+    // the reading is marked invalid.
+    struct CounterReading
+    {
+        bool valid = false;
+        double instructions = 0;
+        double l1Misses = 0;            // level 1 data cache read misses
+        double cacheMisses = 0;         // last level cache misses
+    };
+
+    class HardwareCounters
+    {
+    public:
+        HardwareCounters();
+        ~HardwareCounters();
+
+        void start() noexcept;
+        CounterReading stop() noexcept;
+
+    private:
+        int events[3] = { -1, -1, -1 };
+    };
+
+    void printHeading(const String& title);
+    void printResult(const String& name, double value, const String& unit, const String& note = {});
+
+    // One voice behind a VoiceManager, driven the way the processor drives it:
+    // capture, block start, then the render split at each MIDI event
+    struct VoiceRig
+    {
+        VoiceRig(double sampleRate, int blockSize, bool doublePrecision = false);
+
+        template <typename T>
+        void process(AudioBuffer<T>& buffer, const MidiBuffer& midi)
+        {
+            int n = buffer.getNumSamples();
+            voice->capture(buffer.getReadPointer(0), buffer.getReadPointer(1), n);
+            voice->blockStarted(n, {});
+            synth.renderNextBlock(buffer, midi, 0, n);
+        }
+
+        // Starts a held note, capturing and rendering one block of input
+        template <typename T>
+        void startNote(AudioBuffer<T>& buffer, int note)
+        {
+            MidiBuffer midi;
+            const uint8 noteOn[] = { 0x90, (uint8)note, 100 };
+            midi.addEvent(noteOn, 3, 0);
+            process(buffer, midi);
+        }
+
+        TraceRecorder trace;
+        VoiceManager synth;
+        SynthVoice* voice = nullptr;
+    };
+
+    // Two partials and a little noise, the same on every run
+    void fillInput(AudioBuffer<float>& buffer, double sampleRate);
+
+    void runBlockCost();
+    void runReadHead();
+    void runPitchMath();
+    void runOnsetDetector();
+    void runVoiceManager();
+    void runGrains();
+    void runLayout();
+}
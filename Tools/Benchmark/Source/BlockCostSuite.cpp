@@ -0,0 +1,63 @@
+#include "Benchmark.h"
+
+// What one instance costs per block in each state. Idle and muted instances
+// should cost next to nothing, since sessions keep dozens of them loaded.
+void Benchmark::runBlockCost()
+{
+    const double sampleRate = 48000;
+    const int blockSize = 256;
+    const int blocks = 2000;
+    double blockNs = blockSize / sampleRate * 1.0e9;
+    printHeading("Block cost, one voice at 48 kHz, 256-sample blocks");
+
+    AudioBuffer<float> input(2, blockSize), silence(2, blockSize), buffer(2, blockSize);
+    fillInput(input, sampleRate);
+    silence.clear();
+    MidiBuffer noMidi;
+
+    auto copyIn = [&buffer](const AudioBuffer<float>& source) {
+        for (int ch = 0; ch < 2; ch++)
+            std::copy(source.getReadPointer(ch), source.getReadPointer(ch) + blockSize, buffer.getWritePointer(ch));
+    };
+
+    double copyNs = nanosecondsPerCall(blocks, [&] {
+        copyIn(input);
+        keep(buffer.getReadPointer(0)[0]);
+    });
+    printResult("copying the input in (included below)", copyNs, "ns/block");
+
+    struct State
+    {
+        String name;
+        bool playing;
+        bool silent;
+        float wet;
+        float dry;
+        float attack = 0;
+        float curve = 0;
+    };
+    for (auto& state : { State{ "idle, dry 0", false, false, 1, 0 },
+                         State{ "idle, dry 100", false, false, 1, 1 },
+                         State{ "idle, dry 50", false, false, 1, 0.5f },
+                         State{ "idle, silent input", false, true, 1, 0.5f },
+                         State{ "playing", true, false, 1, 0 },
+                         State{ "playing, silent input", true, true, 1, 0 },
+                         State{ "playing, wet and dry 0", true, false, 0, 0 },
+                         State{ "attacking, linear", true, false, 1, 0.5f, 1000, 0 },
+                         State{ "attacking, curved", true, false, 1, 0.5f, 1000, 0.5f } }) {
+        VoiceRig rig(sampleRate, blockSize);
+        rig.voice->wetDryChanged(state.wet, state.dry);
+        if (state.attack > 0) rig.voice->adsrChanged(state.attack, 0, 1, 0.1f, state.curve);
+        rig.voice->resetState();
+        copyIn(input);
+        if (state.playing) rig.startNote(buffer, 57);
+
+        const auto& source = state.silent ? silence : input;
+        double ns = nanosecondsPerCall(blocks, [&] {
+            copyIn(source);
+            rig.process(buffer, noMidi);
+            keep(buffer.getReadPointer(0)[blockSize - 1]);
+        });
+        printResult(state.name, ns, "ns/block", String(ns / blockNs * 100, 3) + "% of the block");
+    }
+}
@@ -0,0 +1,40 @@
+#include "Benchmark.h"
+
+// How the granular engine's cost grows with the grain count, against the plain read
+// head, at the 96 kHz where 32 grains per voice has to stay affordable
+void Benchmark::runGrains()
+{
+    const double sampleRate = 96000;
+    const int blockSize = 256;
+    const int blocks = 1000;
+    double sampleNs = 1.0e9 / sampleRate;
+    printHeading("Granular cost by grain count, one voice at 96 kHz");
+
+    AudioBuffer<float> input(2, blockSize), buffer(2, blockSize);
+    fillInput(input, sampleRate);
+    auto copyIn = [&] {
+        for (int ch = 0; ch < 2; ch++)
+            std::copy(input.getReadPointer(ch), input.getReadPointer(ch) + blockSize, buffer.getWritePointer(ch));
+    };
+
+    for (int numGrains : { 0, 1, 2, 4, 8, 16, 32 }) {
+        VoiceRig rig(sampleRate, blockSize);
+        rig.voice->granularChanged(numGrains > 0, std::max(1, numGrains), 0.05f, 0.25f, 2);
+        rig.voice->resetState();
+        for (int b = 0; b < 400; b++) {
+            copyIn();
+            rig.process(buffer, {});
+        }
+        copyIn();
+        rig.startNote(buffer, 57);
+
+        MidiBuffer noMidi;
+        double ns = nanosecondsPerCall(blocks, [&] {
+            copyIn();
+            rig.process(buffer, noMidi);
+            keep(buffer.getReadPointer(0)[blockSize - 1]);
+        }) / blockSize;
+        String name = numGrains == 0 ? String("plain read head") : String(numGrains) + (numGrains == 1 ? " grain" : " grains");
+        printResult(name, ns, "ns/sample", String(ns / sampleNs * 100, 2) + "% of real time");
+    }
+}
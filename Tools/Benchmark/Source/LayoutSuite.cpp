@@ -0,0 +1,124 @@
+#include "Benchmark.h"
+#include "../../../Source/Core/CoreRandom.h"
+#include "../../../Source/Core/FixedDelayBuffer.h"
+
+// Interleaved stereo frames, as FreezeTables stores them, against one table per
+// channel, read the way the voice reads them: an interpolated stereo tap per
+// sample, each read head looping a cycle that ends somewhere in the table. One
+// interleaved tap touches one cache line where the split layout touches two; that
+// only matters once the taps miss, so the cases go from one warm head to heads
+// spread over many cold tables.
+namespace
+{
+    struct Head
+    {
+        int table = 0;
+        double position = 0;
+        double end = 0;
+        double cycle = 0;
+        double rate = 0;
+    };
+
+    template <bool interleaved>
+    struct LayoutRig
+    {
+        static constexpr int size = FixedDelayBuffer<float>::defaultSize;
+
+        LayoutRig(int numTables, int numHeads)
+        {
+            CoreRandom random(7);
+            tables.resize((size_t)numTables);
+            for (auto& table : tables) {
+                table.resize((size_t)(size + 1) * 2);
+                for (auto& s : table) s = random.nextFloat() * 2 - 1;
+            }
+            for (int h = 0; h < numHeads; h++) {
+                Head head;
+                head.table = h % numTables;
+                head.end = size - 2 - random.nextFloat() * size / 2;
+                head.cycle = 200 + random.nextFloat() * 1800;
+                head.position = head.end - head.cycle * random.nextFloat();
+                head.rate = 0.5 + random.nextFloat();
+                heads.push_back(head);
+            }
+        }
+
+        // samplesPerTurn taps from each head in turn
+        void run(int samplesPerTurn) noexcept
+        {
+            float sumL = 0, sumR = 0;
+            for (auto& head : heads) {
+                const float* data = tables[(size_t)head.table].data();
+                for (int i = 0; i < samplesPerTurn; i++) {
+                    int lower = (int)head.position;
+                    float t = (float)(head.position - lower);
+                    float l0, r0, l1, r1;
+                    if constexpr (interleaved) {
+                        const float* frame = data + 2 * lower;
+                        l0 = frame[0];
+                        r0 = frame[1];
+                        l1 = frame[2];
+                        r1 = frame[3];
+                    }
+                    else {
+                        const float* left = data + lower;
+                        const float* right = data + (size + 1) + lower;
+                        l0 = left[0];
+                        l1 = left[1];
+                        r0 = right[0];
+                        r1 = right[1];
+                    }
+                    sumL += l0 + t * (l1 - l0);
+                    sumR += r0 + t * (r1 - r0);
+                    head.position += head.rate;
+                    if (head.position >= head.end) head.position -= head.cycle;
+                }
+            }
+            Benchmark::keep(sumL + sumR);
+        }
+
+        std::vector<std::vector<float>> tables;
+        std::vector<Head> heads;
+    };
+}
+
+template <bool interleaved>
+static void layoutCase(const String& name, int numTables, int numHeads, int samplesPerTurn)
+{
+    LayoutRig<interleaved> rig(numTables, numHeads);
+    double taps = (double)numHeads * samplesPerTurn;
+    int calls = std::max(1, (int)(4.0e6 / taps));
+    double ns = Benchmark::nanosecondsPerCall(calls, [&] { rig.run(samplesPerTurn); });
+
+    Benchmark::HardwareCounters counters;
+    counters.start();
+    for (int i = 0; i < calls; i++) rig.run(samplesPerTurn);
+    auto counts = counters.stop();
+    String note = "no hardware counters";
+    if (counts.valid) {
+        double total = taps * calls;
+        note = String(counts.instructions / total, 1) + " instructions, " + String(counts.l1Misses / total, 3) + " L1 misses, "
+             + String(counts.cacheMisses / total, 3) + " LLC misses per tap";
+    }
+    Benchmark::printResult(String(interleaved ? "interleaved, " : "split, ") + name, ns / taps, "ns/tap", note);
+}
+
+void Benchmark::runLayout()
+{
+    printHeading("Frozen table layout, interleaved frames against a table per channel");
+
+    // One voice's 256-sample block on a warm table; a block from each of 64 voices,
+    // every table cold when its turn comes; and grain-like heads, 32 to a table over
+    // one table or over 64, taking one tap each in turn
+    struct Case { const char* name; int tables, heads, samplesPerTurn; };
+    const Case cases[] = {
+        { "1 head, blocks", 1, 1, 256 },
+        { "64 tables, blocks", 64, 64, 256 },
+        { "32 heads, 1 table", 1, 32, 1 },
+        { "2048 heads, 64 tables", 64, 32 * 64, 1 },
+    };
+    for (auto& c : cases) {
+        layoutCase<true>(c.name, c.tables, c.heads, c.samplesPerTurn);
+        layoutCase<false>(c.name, c.tables, c.heads, c.samplesPerTurn);
+    }
+}
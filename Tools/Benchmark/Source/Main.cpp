@@ -0,0 +1,48 @@
+#include <JuceHeader.h>
+#include "Benchmark.h"
+
+struct Suite
+{
+    const char* name;
+    void (*run)();
+};
+
+static const Suite suites[] = {
+    { "block", Benchmark::runBlockCost },
+    { "readhead", Benchmark::runReadHead },
+    { "pitch", Benchmark::runPitchMath },
+    { "onset", Benchmark::runOnsetDetector },
+    { "voices", Benchmark::runVoiceManager },
+    { "grains", Benchmark::runGrains },
+    { "layout", Benchmark::runLayout },
+};
+
+static void run(const ArgumentList& args)
+{
+    String only = args.containsOption("--suite") ? args.getValueForOption("--suite") : String();
+    bool found = false;
+    for (auto& suite : suites) {
+        if (only.isNotEmpty() && only != suite.name) continue;
+        suite.run();
+        found = true;
+    }
+    if (!found) ConsoleApplication::fail("no suite called " + only);
+}
+
+int main(int argc, char* argv[])
+{
+    ScopedJuceInitialiser_GUI juce;
+
+    String names;
+    for (auto& suite : suites) names += String(names.isEmpty() ? "" : ", ") + suite.name;
+
+    ConsoleApplication app;
+    app.addHelpCommand("--help|-h", "Icebox benchmarks", true);
+    app.addDefaultCommand({ "",
+                            "[--suite <name>]",
+                            "Times the engine's hot paths",
+                            "Runs every suite, or only the named one (" + names + "). Build in release "
+                            "for meaningful figures.",
+                            run });
+    return app.findAndRunCommand(argc, argv);
+}
@@ -0,0 +1,48 @@
+#include "Benchmark.h"
+#include "../../../Source/Core/OnsetDetector.h"
+
+// The auto-freeze detector runs on every block whether or not anything is playing,
+// so it should stay a small, fixed fraction of the block
+template <typename T>
+static double detectorCost(const AudioBuffer<float>& source, int blockSize, double sampleRate)
+{
+    AudioBuffer<T> input(2, source.getNumSamples());
+    for (int ch = 0; ch < 2; ch++)
+        for (int i = 0; i < source.getNumSamples(); i++) input.getWritePointer(ch)[i] = (T)source.getReadPointer(ch)[i];
+
+    OnsetDetector detector;
+    detector.prepare(sampleRate);
+    detector.setSensitivity(0.5f);
+    int numBlocks = input.getNumSamples() / blockSize;
+    double ns = Benchmark::nanosecondsPerCall(20, [&] {
+        int found = 0;
+        for (int b = 0; b < numBlocks; b++)
+            found += detector.process(input.getReadPointer(0) + b * blockSize, input.getReadPointer(1) + b * blockSize, blockSize) >= 0;
+        Benchmark::keep(found);
+    });
+    return ns / numBlocks;
+}
+
+void Benchmark::runOnsetDetector()
+{
+    const double sampleRate = 48000;
+    const int blockSize = 256;
+    double blockNs = blockSize / sampleRate * 1.0e9;
+    printHeading("Onset detector at 48 kHz, 256-sample blocks");
+
+    // Steady tone, then the same tone with a hit every 250 ms
+    AudioBuffer<float> steady(2, 48000);
+    fillInput(steady, sampleRate);
+    AudioBuffer<float> hits(steady);
+    for (int start = 6000; start < hits.getNumSamples(); start += 12000)
+        for (int i = start; i < jmin(start + 200, hits.getNumSamples()); i++)
+            for (int ch = 0; ch < 2; ch++) hits.getWritePointer(ch)[i] *= 3;
+
+    auto show = [blockNs](const String& name, double ns) {
+        printResult(name, ns, "ns/block", String(ns / blockNs * 100, 4) + "% of the block");
+    };
+    show("steady input, float", detectorCost<float>(steady, blockSize, sampleRate));
+    show("steady input, double", detectorCost<double>(steady, blockSize, sampleRate));
+    show("hits every 250 ms, float", detectorCost<float>(hits, blockSize, sampleRate));
+    show("hits every 250 ms, double", detectorCost<double>(hits, blockSize, sampleRate));
+}
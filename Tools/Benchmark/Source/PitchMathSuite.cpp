@@ -0,0 +1,36 @@
+#include "Benchmark.h"
+#include "../../../Source/Core/CoreRandom.h"
+#include "../../../Source/Core/PitchMath.h"
+
+// Each conversion over a block of random inputs, against the std::pow call it replaced
+template <typename Conversion>
+static double conversionCost(const std::vector<float>& inputs, Conversion convert)
+{
+    double ns = Benchmark::nanosecondsPerCall(200, [&] {
+        float sum = 0;
+        for (float x : inputs) sum += convert(x);
+        Benchmark::keep(sum);
+    });
+    return ns / (double)inputs.size();
+}
+
+void Benchmark::runPitchMath()
+{
+    printHeading("Pitch math, per conversion");
+
+    CoreRandom random(1234);
+    std::vector<float> semitones(4096), octaves(4096), notes(4096);
+    for (size_t i = 0; i < semitones.size(); i++) {
+        semitones[i] = (random.nextFloat() * 2 - 1) * PitchMath::semitoneRange;
+        octaves[i] = (random.nextFloat() * 2 - 1) * 8;
+        notes[i] = (float)(int)(random.nextFloat() * 128);
+    }
+
+    printResult("std::pow(2, semitones / 12)", conversionCost(semitones, [](float s) { return std::pow(2.f, s / 12); }), "ns");
+    printResult("PitchMath::semitonesToRatio", conversionCost(semitones, [](float s) { return PitchMath::semitonesToRatio(s); }), "ns");
+    printResult("std::pow(2, x)", conversionCost(octaves, [](float x) { return std::pow(2.f, x); }), "ns");
+    printResult("std::exp2(x)", conversionCost(octaves, [](float x) { return std::exp2(x); }), "ns");
+    printResult("PitchMath::fastExp2", conversionCost(octaves, [](float x) { return PitchMath::fastExp2(x); }), "ns");
+    printResult("440 * std::pow(2, (note - 69) / 12)", conversionCost(notes, [](float n) { return 440 * std::pow(2.f, (n - 69) / 12); }), "ns");
+    printResult("PitchMath::noteToHz", conversionCost(notes, [](float n) { return PitchMath::noteToHz((int)n); }), "ns");
+}
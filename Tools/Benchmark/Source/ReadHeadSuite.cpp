@@ -0,0 +1,52 @@
+#include "Benchmark.h"
+
+// The read head on its own, in each precision. A slow formant glide keeps the
+// voice off the loop cache. With many instances every table is cold by the time it
+// comes round again.
+template <typename T>
+static double readHeadCost(int instances, double sampleRate, int blockSize)
+{
+    AudioBuffer<float> input(2, blockSize);
+    Benchmark::fillInput(input, sampleRate);
+    AudioBuffer<T> buffer(2, blockSize);
+    auto copyIn = [&] {
+        for (int ch = 0; ch < 2; ch++)
+            for (int i = 0; i < blockSize; i++) buffer.getWritePointer(ch)[i] = (T)input.getReadPointer(ch)[i];
+    };
+
+    std::vector<std::unique_ptr<Benchmark::VoiceRig>> rigs;
+    for (int k = 0; k < instances; k++) {
+        rigs.push_back(std::make_unique<Benchmark::VoiceRig>(sampleRate, blockSize, sizeof(T) == sizeof(double)));
+        rigs.back()->voice->formantEnvelopeChanged(12, 0.01f, false);
+        for (int b = 0; b < 400; b++) {
+            copyIn();
+            rigs.back()->process(buffer, {});
+        }
+        copyIn();
+        rigs.back()->startNote(buffer, 45 + k % 24);
+    }
+
+    MidiBuffer noMidi;
+    int blocks = std::max(4, 2000 / instances);
+    double ns = Benchmark::nanosecondsPerCall(blocks, [&] {
+        for (auto& rig : rigs) {
+            copyIn();
+            rig->process(buffer, noMidi);
+        }
+        Benchmark::keep(buffer.getReadPointer(0)[0]);
+    });
+    return ns / instances / blockSize;
+}
+
+void Benchmark::runReadHead()
+{
+    const double sampleRate = 48000;
+    const int blockSize = 256;
+    printHeading("Read head throughput, per voice with capture and glides, gliding at 48 kHz");
+
+    for (int instances : { 1, 64 }) {
+        String suffix = instances == 1 ? ", 1 instance" : ", " + String(instances) + " instances";
+        printResult("float" + suffix, readHeadCost<float>(instances, sampleRate, blockSize), "ns/sample");
+        printResult("double" + suffix, readHeadCost<double>(instances, sampleRate, blockSize), "ns/sample");
+    }
+}
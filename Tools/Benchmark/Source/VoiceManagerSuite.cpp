@@ -0,0 +1,119 @@
+#include "Benchmark.h"
+
+// juce::Synthesiser needs its voices behind SynthesiserVoice and a sound for them to
+// match, which is how the processor drove SynthVoice before VoiceManager replaced it
+namespace
+{
+    struct AnySound : public SynthesiserSound
+    {
+        bool appliesToNote(int) override { return true; }
+        bool appliesToChannel(int) override { return true; }
+    };
+
+    class AdaptedVoice : public SynthesiserVoice
+    {
+    public:
+        explicit AdaptedVoice(SynthVoice& v) : voice(v) {}
+
+        bool canPlaySound(SynthesiserSound* sound) override { return dynamic_cast<AnySound*>(sound) != nullptr; }
+
+        void startNote(int note, float velocity, SynthesiserSound*, int pitchWheel) override
+        {
+            voice.setKeyDown(true);
+            voice.startNote(note, velocity, pitchWheel);
+        }
+
+        void stopNote(float velocity, bool allowTailOff) override
+        {
+            voice.setKeyDown(false);
+            voice.stopNote(velocity, allowTailOff);
+            if (!voice.isVoiceActive()) clearCurrentNote();
+        }
+
+        void pitchWheelMoved(int value) override { voice.pitchWheelMoved(value); }
+        void controllerMoved(int controller, int value) override { voice.controllerMoved(controller, value); }
+
+        void renderNextBlock(AudioBuffer<float>& buffer, int startSample, int numSamples) override
+        {
+            voice.renderNextBlock(buffer.getWritePointer(0), buffer.getWritePointer(1), startSample, numSamples);
+            if (!voice.isVoiceActive()) clearCurrentNote();
+        }
+
+        void renderNextBlock(AudioBuffer<double>& buffer, int startSample, int numSamples) override
+        {
+            voice.renderNextBlock(buffer.getWritePointer(0), buffer.getWritePointer(1), startSample, numSamples);
+            if (!voice.isVoiceActive()) clearCurrentNote();
+        }
+
+    private:
+        SynthVoice& voice;
+    };
+}
+
+// A held note with the given number of pitch bends spread over each block
+static MidiBuffer makeBends(int blockSize, int bendsPerBlock)
+{
+    MidiBuffer midi;
+    for (int k = 0; k < bendsPerBlock; k++) {
+        int value = 8192 + (k % 2 == 0 ? 1000 : -1000);
+        const uint8 bend[] = { 0xe0, (uint8)(value & 0x7f), (uint8)(value >> 7) };
+        midi.addEvent(bend, 3, k * blockSize / bendsPerBlock);
+    }
+    return midi;
+}
+
+// The same voice, the same input and the same MIDI through each manager; the
+// difference is what the manager itself costs
+void Benchmark::runVoiceManager()
+{
+    const double sampleRate = 48000;
+    const int blockSize = 256;
+    const int blocks = 2000;
+    printHeading("VoiceManager against juce::Synthesiser, one playing voice at 48 kHz");
+
+    AudioBuffer<float> input(2, blockSize), buffer(2, blockSize);
+    fillInput(input, sampleRate);
+    auto copyIn = [&] {
+        for (int ch = 0; ch < 2; ch++)
+            std::copy(input.getReadPointer(ch), input.getReadPointer(ch) + blockSize, buffer.getWritePointer(ch));
+    };
+
+    for (int bendsPerBlock : { 0, 1, 8 }) {
+        MidiBuffer midi = makeBends(blockSize, bendsPerBlock);
+        String events = bendsPerBlock == 0 ? String("no events")
+                      : String(bendsPerBlock) + (bendsPerBlock == 1 ? " event" : " events") + " per block";
+
+        VoiceRig managed(sampleRate, blockSize);
+        copyIn();
+        managed.startNote(buffer, 57);
+        double managerNs = nanosecondsPerCall(blocks, [&] {
+            copyIn();
+            managed.process(buffer, midi);
+            keep(buffer.getReadPointer(0)[blockSize - 1]);
+        });
+
+        VoiceRig wrapped(sampleRate, blockSize);
+        Synthesiser synth;
+        synth.addSound(new AnySound());
+        synth.addVoice(new AdaptedVoice(*wrapped.voice));
+        synth.setCurrentPlaybackSampleRate(sampleRate);
+        auto process = [&](const MidiBuffer& events) {
+            wrapped.voice->capture(buffer.getReadPointer(0), buffer.getReadPointer(1), blockSize);
+            wrapped.voice->blockStarted(blockSize, {});
+            synth.renderNextBlock(buffer, events, 0, blockSize);
+        };
+        MidiBuffer noteOn;
+        noteOn.addEvent(MidiMessage::noteOn(1, 57, (uint8)100), 0);
+        copyIn();
+        process(noteOn);
+        double synthesiserNs = nanosecondsPerCall(blocks, [&] {
+            copyIn();
+            process(midi);
+            keep(buffer.getReadPointer(0)[blockSize - 1]);
+        });
+
+        printResult("VoiceManager, " + events, managerNs, "ns/block");
+        printResult("juce::Synthesiser, " + events, synthesiserNs, "ns/block",
+                    (synthesiserNs >= managerNs ? "+" : "") + String(synthesiserNs - managerNs, 0) + " ns");
+    }
+}
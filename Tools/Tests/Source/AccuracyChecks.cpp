@@ -0,0 +1,147 @@
+#include "AccuracyChecks.h"
+#include "../../../Source/Core/CoreRandom.h"
+#include "../../../Source/Core/Envelope.h"
+#include "../../../Source/Core/FixedDelayBuffer.h"
+#include "../../../Source/Core/PitchMath.h"
+
+template <typename Approximation, typename Exact>
+static double worstRelativeError(float low, float high, int steps, Approximation approximate, Exact exact)
+{
+    double worst = 0;
+    for (int i = 0; i <= steps; i++) {
+        float x = low + (high - low) * (float)i / (float)steps;
+        worst = jmax(worst, std::abs(approximate(x) / exact(x) - 1));
+    }
+    return worst;
+}
+
+StringArray checkPitchMath(String& summary)
+{
+    // The bounds stated in PitchMath.h
+    const double tableBound = 6.0e-7;
+    const double fastExp2Bound = 1.8e-7;
+
+    double tableError = worstRelativeError((float)-PitchMath::semitoneRange, (float)PitchMath::semitoneRange, 2000000,
+        [](float s) { return (double)PitchMath::semitonesToRatio(s); },
+        [](float s) { return std::exp2(s / 12.0); });
+    double fastExp2Error = worstRelativeError(-126.f, 126.f, 2000000,
+        [](float x) { return (double)PitchMath::fastExp2(x); },
+        [](float x) { return std::exp2((double)x); });
+
+    summary = "semitone table " + String(tableError, 9) + ", fastExp2 " + String(fastExp2Error, 9);
+    StringArray failures;
+    if (!(tableError < tableBound)) failures.add("semitone table error is over " + String(tableBound, 9));
+    if (!(fastExp2Error < fastExp2Bound)) failures.add("fastExp2 error is over " + String(fastExp2Bound, 9));
+    return failures;
+}
+
+// Renders until the envelope passes `level` in the direction it is heading, and
+// returns how many samples that took, or -1 if it hasn't within `limit`
+static int samplesToReach(Envelope& envelope, float level, bool rising, int limit)
+{
+    for (int i = 1; i <= limit; i++) {
+        float out;
+        envelope.render(&out, 1);
+        if (rising ? out >= level : out <= level) return i;
+    }
+    return -1;
+}
+
+StringArray checkEnvelope(String& summary)
+{
+    // At 1 kHz a segment of s seconds is 1000 s samples; linear segments make the
+    // expected lengths exact
+    Envelope envelope;
+    envelope.setSampleRate(1000);
+    envelope.setCurve(0);
+    envelope.setParameters(0.1f, 0.1f, 0.5f, 0.1f);
+    envelope.noteOn();
+    StringArray failures;
+
+    // Halfway up a 100-sample attack, stretching it to 200 leaves 100 samples to go
+    samplesToReach(envelope, 0.5f, true, 100);
+    envelope.setParameters(0.2f, 0.1f, 0.5f, 0.1f);
+    int attackLeft = samplesToReach(envelope, 1, true, 1000);
+    if (std::abs(attackLeft - 100) > 1) failures.add("attack took " + String(attackLeft) + " samples after a change, not 100");
+
+    // Lowering the sustain level mid-decay moves where the decay ends
+    samplesToReach(envelope, 0.75f, false, 1000);
+    envelope.setParameters(0.2f, 0.1f, 0.25f, 0.1f);
+    samplesToReach(envelope, 0.25f, false, 1000);
+    float held;
+    envelope.render(&held, 1);
+    if (held != 0.25f) failures.add("decay settled at " + String(held) + ", not the new sustain level");
+
+    // A held note follows the sustain level
+    envelope.setParameters(0.2f, 0.1f, 0.8f, 0.1f);
+    envelope.render(&held, 1);
+    if (held != 0.8f) failures.add("sustain stayed at " + String(held) + " after a change to 0.8");
+
+    // Halfway down a 100-sample release, stretching it to 400 leaves 200 samples
+    envelope.noteOff();
+    samplesToReach(envelope, 0.4f, false, 100);
+    envelope.setParameters(0.2f, 0.1f, 0.8f, 0.4f);
+    int releaseLeft = samplesToReach(envelope, 0, false, 1000);
+    if (std::abs(releaseLeft - 200) > 1) failures.add("release took " + String(releaseLeft) + " samples after a change, not 200");
+
+    // Curved segments change rate from wherever they are, without jumping
+    envelope.setCurve(0.5f);
+    envelope.noteOn();
+    samplesToReach(envelope, 0.5f, true, 100);
+    envelope.setParameters(1, 0.1f, 0.8f, 0.4f);
+    float previous = 0.5f;
+    float largestStep = 0;
+    int curvedLeft = 0;
+    for (float out = 0; out < 1 && curvedLeft <= 2000; curvedLeft++) {
+        envelope.render(&out, 1);
+        largestStep = jmax(largestStep, std::abs(out - previous));
+        previous = out;
+    }
+    if (curvedLeft > 2000 || largestStep > 0.01f)
+        failures.add("curved attack took " + String(curvedLeft) + " samples with a largest step of " + String(largestStep) + " after a change");
+
+    summary = "attack " + String(attackLeft) + ", release " + String(releaseLeft) + ", curved attack " + String(curvedLeft) + " samples after a change";
+    return failures;
+}
+
+StringArray checkCaptureStats(String& summary)
+{
+    // A size that isn't a whole number of blocks, written in blocks of varying length
+    // so the write head lands at every offset within a block
+    const int size = 5000;
+    FixedDelayBuffer<float> ring(size);
+    CoreRandom random(99);
+    std::vector<float> input(700);
+    for (int written = 0; written < 3 * size;) {
+        int n = 1 + (int)(random.nextFloat() * (float)(input.size() - 1));
+        for (int i = 0; i < n; i++) input[(size_t)i] = random.nextFloat() * 2 - 1;
+        ring.writeBlock(input.data(), n);
+        written += n;
+    }
+    std::vector<float> ordered((size_t)size);
+    ring.copyOrdered(ordered.data());
+
+    double worst = 0;
+    int mismatches = 0;
+    for (int trial = 0; trial < 2000; trial++) {
+        int delay = (int)(random.nextFloat() * (float)size);
+        int numSamples = 1 + (int)(random.nextFloat() * (float)(size - delay - 1));
+        auto stats = ring.getRecentStats(numSamples, delay);
+
+        double sum = 0, squares = 0;
+        float peak = 0;
+        for (int i = size - delay - numSamples; i < size - delay; i++) {
+            sum += ordered[(size_t)i];
+            squares += (double)ordered[(size_t)i] * ordered[(size_t)i];
+            peak = jmax(peak, std::abs(ordered[(size_t)i]));
+        }
+        worst = jmax(worst, std::abs(stats.sum - sum), std::abs(stats.squares - squares));
+        if (stats.count != numSamples || stats.peak != peak) mismatches++;
+    }
+
+    summary = "worst sum error " + String(worst, 9) + ", " + String(mismatches) + " count or peak mismatches";
+    StringArray failures;
+    if (!(worst < 1.0e-9)) failures.add("sums are off by " + String(worst, 9));
+    if (mismatches > 0) failures.add(String(mismatches) + " windows had the wrong count or peak");
+    return failures;
+}
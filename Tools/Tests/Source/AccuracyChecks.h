@@ -0,0 +1,14 @@
+#pragma once
+#include <JuceHeader.h>
+
+// Sweeps each approximation against double precision and returns a line for every
+// one that misses its documented bound; `summary` gets the worst errors found
+StringArray checkPitchMath(String& summary);
+
+// Changes the envelope's parameters partway through each kind of segment and checks
+// the segment carries on from where it was, at the new rate, to the new end point
+StringArray checkEnvelope(String& summary);
+
+// Compares the capture ring's block-based level statistics with a direct scan over
+// windows of every length and position, including ones that cut through a block
+StringArray checkCaptureStats(String& summary);
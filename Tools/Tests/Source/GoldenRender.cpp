@@ -0,0 +1,117 @@
+#include "GoldenRender.h"
+#include "../../../Source/Core/CoreRandom.h"
+
+// Two detuned partials and a little noise, slightly different on each side
+static void fillInput(float* left, float* right, int start, int numSamples, double sampleRate, CoreRandom& random)
+{
+    const double twoPi = 6.283185307179586;
+    for (int i = 0; i < numSamples; i++) {
+        double t = (start + i) / sampleRate;
+        float noise = 0.05f * (random.nextFloat() * 2 - 1);
+        left[i] = (float)(0.4 * std::sin(twoPi * 220 * t) + 0.2 * std::sin(twoPi * 1375 * t)) + noise;
+        right[i] = (float)(0.4 * std::sin(twoPi * 220 * t + 0.3) + 0.2 * std::sin(twoPi * 1380 * t)) + noise;
+    }
+}
+
+// A held note, a second note over it, a pitch bend, then both released, spaced
+// in proportion to the length of the render
+static MidiBuffer makeScript(int note, int length)
+{
+    MidiBuffer midi;
+    const uint8 firstOn[] = { 0x90, (uint8)note, 100 };
+    const uint8 secondOn[] = { 0x90, (uint8)(note + 3), 80 };
+    const uint8 bend[] = { 0xe0, 0x75, 0x4a };
+    const uint8 firstOff[] = { 0x80, (uint8)note, 0 };
+    const uint8 secondOff[] = { 0x80, (uint8)(note + 3), 0 };
+    midi.addEvent(firstOn, 3, length / 8);
+    midi.addEvent(secondOn, 3, length / 2);
+    midi.addEvent(bend, 3, length / 512 * 325);
+    midi.addEvent(firstOff, 3, length / 4 * 3);
+    midi.addEvent(secondOff, 3, length / 4 * 3);
+    return midi;
+}
+
+// A transport that is always playing at a fixed tempo, positioned at the block being rendered
+class GoldenPlayHead : public AudioPlayHead
+{
+public:
+    GoldenPlayHead(double bpm, double sampleRate) : bpm(bpm), sampleRate(sampleRate) {}
+
+    Optional<PositionInfo> getPosition() const override
+    {
+        PositionInfo position;
+        position.setIsPlaying(true);
+        position.setBpm(bpm);
+        position.setTimeInSamples(samplePosition);
+        position.setPpqPosition(samplePosition / sampleRate * bpm / 60);
+        return position;
+    }
+
+    int64 samplePosition = 0;
+
+private:
+    double bpm;
+    double sampleRate;
+};
+
+template <typename T>
+static void render(const GoldenCase& test, AudioBuffer<float>& output, std::vector<int64>& blockTicks)
+{
+    IceboxAudioProcessor processor;
+    GoldenPlayHead playHead(test.bpm, test.sampleRate);
+    if (test.bpm > 0) processor.setPlayHead(&playHead);
+    processor.setNonRealtime(true);
+    processor.setProcessingPrecision(test.doublePrecision ? AudioProcessor::doublePrecision : AudioProcessor::singlePrecision);
+    processor.setRateAndBufferSizeDetails(test.sampleRate, GoldenCase::blockSize);
+    processor.prepareToPlay(test.sampleRate, GoldenCase::blockSize);
+    if (test.setup) test.setup(processor);
+
+    MidiBuffer script = makeScript(test.note, test.numSamples);
+    CoreRandom random(1234);
+    AudioBuffer<float> input(2, GoldenCase::blockSize);
+    AudioBuffer<T> block(2, GoldenCase::blockSize);
+    MidiBuffer midi;
+
+    for (int start = 0, index = 0; start < test.numSamples; start += GoldenCase::blockSize, index++) {
+        int n = GoldenCase::blockSize;
+        fillInput(input.getWritePointer(0), input.getWritePointer(1), start, n, test.sampleRate, random);
+        for (int ch = 0; ch < 2; ch++)
+            for (int i = 0; i < n; i++) block.getWritePointer(ch)[i] = (T)input.getReadPointer(ch)[i];
+
+        midi.clear();
+        for (auto it = script.findNextSamplePosition(start); it != script.end(); ++it) {
+            const auto event = *it;
+            if (event.samplePosition >= start + n) break;
+            midi.addEvent(event.data, event.numBytes, event.samplePosition - start);
+        }
+
+        playHead.samplePosition = start;
+        int64 begin = Time::getHighResolutionTicks();
+        processor.processBlock(block, midi);
+        int64 ticks = Time::getHighResolutionTicks() - begin;
+        blockTicks[(size_t)index] = blockTicks[(size_t)index] < 0 ? ticks : jmin(blockTicks[(size_t)index], ticks);
+
+        for (int ch = 0; ch < 2; ch++)
+            for (int i = 0; i < n; i++) output.getWritePointer(ch)[start + i] = (float)block.getReadPointer(ch)[i];
+    }
+    processor.releaseResources();
+}
+
+GoldenResult renderGoldenCase(const GoldenCase& test, int runs)
+{
+    GoldenResult result;
+    result.output.setSize(2, test.numSamples);
+    std::vector<int64> blockTicks((size_t)(test.numSamples / GoldenCase::blockSize), -1);
+    for (int run = 0; run < runs; run++) {
+        if (test.doublePrecision) render<double>(test, result.output, blockTicks);
+        else render<float>(test, result.output, blockTicks);
+    }
+
+    double blockSeconds = GoldenCase::blockSize / test.sampleRate;
+    for (auto ticks : blockTicks) {
+        double load = ticks / Time::getHighResolutionTicksPerSecond() / blockSeconds;
+        result.meanBlockLoad += load / (double)blockTicks.size();
+        result.worstBlockLoad = jmax(result.worstBlockLoad, load);
+    }
+    return result;
+}
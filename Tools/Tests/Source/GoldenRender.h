@@ -0,0 +1,37 @@
+#pragma once
+#include <JuceHeader.h>
+#include <functional>
+#include "../../../Source/PluginProcessor.h"
+
+// A scripted performance rendered offline through IceboxAudioProcessor the way a host
+// drives it: setup() sets parameters through the parameter objects, then every block
+// goes through processBlock with its MIDI. The input, MIDI and block size are fixed,
+// so the output is too.
+struct GoldenCase
+{
+    static constexpr int blockSize = 256;
+
+    String name;
+    int numSamples = 4096;
+    double sampleRate = 48000;
+    bool doublePrecision = false;
+    int note = 57;
+    double bpm = 0;                 // when set, a play head reports this tempo from the song's start
+    std::function<void(IceboxAudioProcessor&)> setup;
+
+    // Render time per block as a fraction of the block's duration: the mean over
+    // the performance, and the slowest block, which is usually the freeze
+    double budget = 0.02;
+    double worstBudget = 0.5;
+};
+
+struct GoldenResult
+{
+    AudioBuffer<float> output;      // double renders are rounded to float
+    double meanBlockLoad = 0;
+    double worstBlockLoad = 0;
+};
+
+// Renders the case several times; each block's time is its fastest run, which
+// keeps scheduler noise out of the load figures
+GoldenResult renderGoldenCase(const GoldenCase& test, int runs = 5);
@@ -0,0 +1,203 @@
+#include <JuceHeader.h>
+#include "AccuracyChecks.h"
+#include "GoldenRender.h"
+
+// Both precisions play the default patch; the feature cases then
+// cover each part of the voice in the plugin's default float mode
+static std::vector<GoldenCase> makeCases()
+{
+    std::vector<GoldenCase> cases;
+    auto add = [&cases](String name, std::function<void(IceboxAudioProcessor&)> setup = {}) -> GoldenCase& {
+        GoldenCase test;
+        test.name = name;
+        test.setup = setup;
+        cases.push_back(test);
+        return cases.back();
+    };
+    auto sendOnBus = [](IceboxAudioProcessor& p) { p.setFreezeBus(1); };
+
+    add("float");
+    add("double").doublePrecision = true;
+    add("bus", sendOnBus);
+
+    add("formant", [](IceboxAudioProcessor& p) { *p.formant = 7; });
+    add("portamento", [](IceboxAudioProcessor& p) { *p.portamento = 50; });
+    add("formant-envelope-exp", [](IceboxAudioProcessor& p) {
+        *p.formantDecay = -12;
+        *p.formantDecayRate = 0.5f;
+    });
+    add("formant-envelope-linear", [](IceboxAudioProcessor& p) {
+        *p.formantDecay = -12;
+        *p.formantDecayRate = 0.5f;
+        *p.formantDecayLinear = true;
+    });
+    add("wet-dry", [](IceboxAudioProcessor& p) {
+        *p.wet = 60;
+        *p.dry = 40;
+    });
+    add("granular", [](IceboxAudioProcessor& p) {
+        *p.granular = true;
+        *p.grainLength = 0.05f;
+        *p.grainSpread = 2;
+    }).budget = 0.05;
+    add("spectral", [](IceboxAudioProcessor& p) { *p.spectral = true; }).budget = 0.1;
+    add("normalize", [](IceboxAudioProcessor& p) { *p.freezeLevel = SynthVoice::levelNormalize; });
+    add("normalize-bus", [sendOnBus](IceboxAudioProcessor& p) {
+        *p.freezeLevel = SynthVoice::levelNormalize;
+        sendOnBus(p);
+    });
+
+    // A freeze synced to 1/16 notes, playing only the last 1/32 before the grid line,
+    // both from the voice's own rolls and from the bus. At 1800 bpm that is a 400-sample
+    // grid, short enough for the render.
+    auto syncTo = [](IceboxAudioProcessor& p) {
+        *p.freezeSync = true;
+        *p.freezeGrid = 4;
+        *p.freezeLength = 6;
+    };
+    add("synced", syncTo).bpm = 1800;
+    add("bus-synced", [syncTo, sendOnBus](IceboxAudioProcessor& p) {
+        syncTo(p);
+        sendOnBus(p);
+    }).bpm = 1800;
+
+    // At a tempo no song has, the synced region is only 8 samples long, and the formant
+    // pushed up two octaves steps the read head past more than a whole cycle every sample
+    auto tinyRegion = [syncTo](IceboxAudioProcessor& p) {
+        syncTo(p);
+        *p.formant = 24;
+        *p.formantDecay = 24;
+        *p.formantDecayRate = 2;
+    };
+    add("tiny-region", tinyRegion).bpm = 45000;
+
+    // The same for grains, spread an octave either way and with velocity pushing the
+    // formant and its target further still
+    add("tiny-region-granular", [tinyRegion](IceboxAudioProcessor& p) {
+        tinyRegion(p);
+        *p.granular = true;
+        *p.grainLength = 0.05f;
+        *p.grainSpread = 12;
+        *p.modSource[0] = ModMatrix::velocity;
+        *p.modDestination[0] = ModMatrix::formant;
+        *p.modAmount[0] = 100;
+        *p.modSource[1] = ModMatrix::velocity;
+        *p.modDestination[1] = ModMatrix::formantTarget;
+        *p.modAmount[1] = 100;
+    }).bpm = 45000;
+
+    // The bottom note with the formant and its envelope at the top of their ranges asks
+    // for a cycle several times longer than the frozen table
+    auto& extreme = add("extreme-formant", [](IceboxAudioProcessor& p) {
+        *p.formant = 24;
+        *p.formantDecay = 24;
+        *p.formantDecayRate = 2;
+    });
+    extreme.note = 0;
+    extreme.sampleRate = 96000;
+    extreme.numSamples = 32768;
+    return cases;
+}
+
+static float maxDifference(const AudioBuffer<float>& output, const MemoryBlock& golden, int& where)
+{
+    auto* frames = static_cast<const float*>(golden.getData());
+    float worst = 0;
+    where = -1;
+    for (int i = 0; i < output.getNumSamples(); i++) {
+        for (int ch = 0; ch < 2; ch++) {
+            float difference = std::abs(output.getReadPointer(ch)[i] - frames[2 * i + ch]);
+            if (!(difference <= worst)) {
+                worst = difference;
+                where = i;
+            }
+        }
+    }
+    return worst;
+}
+
+static void saveGolden(const File& file, const AudioBuffer<float>& output)
+{
+    std::vector<float> frames((size_t)(2 * output.getNumSamples()));
+    for (int i = 0; i < output.getNumSamples(); i++) {
+        frames[(size_t)(2 * i)] = output.getReadPointer(0)[i];
+        frames[(size_t)(2 * i + 1)] = output.getReadPointer(1)[i];
+    }
+    if (!file.replaceWithData(frames.data(), frames.size() * sizeof(float)))
+        ConsoleApplication::fail("can't write " + file.getFullPathName());
+}
+
+static void run(const ArgumentList& args)
+{
+    File goldenFolder = args.containsOption("--golden") ? args.getFileForOption("--golden")
+                                                        : File::getCurrentWorkingDirectory().getChildFile("Golden");
+    bool update = args.containsOption("--update");
+    bool checkBudget = !args.containsOption("--no-budget");
+    float tolerance = 1.0e-4f;
+    if (update && !goldenFolder.createDirectory())
+        ConsoleApplication::fail("can't create " + goldenFolder.getFullPathName());
+
+    int failed = 0;
+    auto check = [&failed](String name, StringArray (*run)(String&)) {
+        String summary;
+        auto failures = run(summary);
+        std::cout << name.paddedRight(' ', 26) << summary << "  "
+                  << (failures.isEmpty() ? String("ok") : "FAILED: " + failures.joinIntoString(", ")) << std::endl;
+        failed += failures.size();
+    };
+    check("pitch-math", checkPitchMath);
+    check("envelope", checkEnvelope);
+    check("capture-stats", checkCaptureStats);
+
+    for (auto& test : makeCases()) {
+        auto result = renderGoldenCase(test);
+        auto file = goldenFolder.getChildFile(test.name + ".f32");
+        String status;
+
+        if (update) {
+            saveGolden(file, result.output);
+            status = "updated";
+        }
+        else {
+            MemoryBlock golden;
+            if (!file.loadFileAsData(golden) || golden.getSize() != (size_t)(2 * test.numSamples) * sizeof(float))
+                status = "FAILED: no golden render at " + file.getFullPathName();
+            else {
+                int where;
+                float difference = maxDifference(result.output, golden, where);
+                if (!(difference <= tolerance))
+                    status = "FAILED: differs by " + String(difference, 6) + " at sample " + String(where);
+                else if (checkBudget && result.meanBlockLoad > test.budget)
+                    status = "FAILED: over the " + String(test.budget * 100, 1) + "% mean block budget";
+                else if (checkBudget && result.worstBlockLoad > test.worstBudget)
+                    status = "FAILED: a block is over the " + String(test.worstBudget * 100, 1) + "% budget";
+                else
+                    status = "ok";
+            }
+            if (status != "ok") failed++;
+        }
+
+        std::cout << test.name.paddedRight(' ', 26) << "load mean " << String(result.meanBlockLoad * 100, 3) << "%  worst "
+                  << String(result.worstBlockLoad * 100, 3) << "%  " << status << std::endl;
+    }
+
+    if (failed > 0) ConsoleApplication::fail(String(failed) + " cases failed");
+}
+
+int main(int argc, char* argv[])
+{
+    ScopedJuceInitialiser_GUI juce;
+
+    ConsoleApplication app;
+    app.addHelpCommand("--help|-h", "Icebox golden-render tests", true);
+    app.addDefaultCommand({ "",
+                            "[--golden <folder>] [--update] [--no-budget]",
+                            "Checks the pitch math, the envelope and the capture statistics, then renders fixed MIDI and audio through the plugin and compares it with stored renders",
+                            "Each case sets the plugin's parameters, then plays the same scripted notes over the same input "
+                            "through IceboxAudioProcessor::processBlock, and must match its golden render in <folder> (default ./Golden) to within "
+                            "1e-4. It must also render within its share of each block's real-time duration, "
+                            "on average and in its slowest block; the budgets assume a release build, so use --no-budget for debug builds. "
+                            "--update rewrites the golden renders from the current code.",
+                            run });
+    return app.findAndRunCommand(argc, argv);
+}